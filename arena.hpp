@@ -1,15 +1,24 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
+// Bump allocator handing out memory from fixed-size blocks. When a block is
+// exhausted a new one is chained on, so previously returned pointers stay valid.
+// Objects placed with emplace() that need a destructor (nodes holding a
+// std::string or std::vector) are recorded and destroyed, newest first, on
+// reset() and when the arena goes away.
 class ArenaAllocator {
 public:
-    explicit ArenaAllocator(const size_t max_num_bytes)
-        : m_size { max_num_bytes }
-        , m_buffer { new std::byte[max_num_bytes] }
+    explicit ArenaAllocator(const size_t block_num_bytes)
+        : m_size { block_num_bytes }
+        , m_buffer { new std::byte[block_num_bytes] }
         , m_offset { m_buffer }
+        , m_block_size { block_num_bytes }
     {
     }
 
@@ -20,6 +29,12 @@ public:
         : m_size { std::exchange(other.m_size, 0) }
         , m_buffer { std::exchange(other.m_buffer, nullptr) }
         , m_offset { std::exchange(other.m_offset, nullptr) }
+        , m_block_size { other.m_block_size }
+        , m_retired { std::move(other.m_retired) }
+        , m_retired_used { std::exchange(other.m_retired_used, 0) }
+        , m_retired_capacity { std::exchange(other.m_retired_capacity, 0) }
+        , m_high_water { std::exchange(other.m_high_water, 0) }
+        , m_destructors { std::move(other.m_destructors) }
     {
     }
 
@@ -28,6 +43,12 @@ public:
         std::swap(m_size, other.m_size);
         std::swap(m_buffer, other.m_buffer);
         std::swap(m_offset, other.m_offset);
+        std::swap(m_block_size, other.m_block_size);
+        std::swap(m_retired, other.m_retired);
+        std::swap(m_retired_used, other.m_retired_used);
+        std::swap(m_retired_capacity, other.m_retired_capacity);
+        std::swap(m_high_water, other.m_high_water);
+        std::swap(m_destructors, other.m_destructors);
         return *this;
     }
 
@@ -38,9 +59,11 @@ public:
         auto pointer = static_cast<void*>(m_offset);
         const auto aligned_address = std::align(alignof(T), sizeof(T), pointer, remaining_num_bytes);
         if (aligned_address == nullptr) {
-            throw std::bad_alloc {};
+            grow(sizeof(T) + alignof(T));
+            return alloc<T>();
         }
         m_offset = static_cast<std::byte*>(aligned_address) + sizeof(T);
+        m_high_water = std::max(m_high_water, used());
         return static_cast<T*>(aligned_address);
     }
 
@@ -48,21 +71,93 @@ public:
     [[nodiscard]] T* emplace(Args&&... args)
     {
         const auto allocated_memory = alloc<T>();
-        return new (allocated_memory) T { std::forward<Args>(args)... };
+        T* object = new (allocated_memory) T { std::forward<Args>(args)... };
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            m_destructors.push_back({ object, [](void* p) { static_cast<T*>(p)->~T(); } });
+        }
+        return object;
+    }
+
+    [[nodiscard]] size_t used() const
+    {
+        return m_retired_used + static_cast<size_t>(m_offset - m_buffer);
+    }
+
+    [[nodiscard]] size_t high_water() const
+    {
+        return m_high_water;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return m_retired_capacity + m_size;
+    }
+
+    // Rewinds to empty, destroying and invalidating everything allocated so
+    // far. Chained blocks are merged into one block of the current capacity,
+    // so a reused arena serves a workload of the same size without growing
+    // again.
+    void reset()
+    {
+        destroy_all();
+        if (!m_retired.empty()) {
+            const size_t size = capacity();
+            for (const std::byte* block : m_retired) {
+                delete[] block;
+            }
+            m_retired.clear();
+            delete[] m_buffer;
+            m_buffer = new std::byte[size];
+            m_size = size;
+            m_retired_used = 0;
+            m_retired_capacity = 0;
+        }
+        m_offset = m_buffer;
+        m_high_water = 0;
     }
 
     ~ArenaAllocator()
     {
-        // No destructors are called for the stored objects. Thus, memory
-        // leaks are possible (e.g. when storing std::vector objects or
-        // other non-trivially destructable objects in the allocator).
-        // Although this could be changed, it would come with additional
-        // runtime overhead and therefore is not implemented.
+        destroy_all();
         delete[] m_buffer;
+        for (const std::byte* block : m_retired) {
+            delete[] block;
+        }
     }
 
 private:
+    struct Destructor {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    void destroy_all()
+    {
+        for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+            it->destroy(it->object);
+        }
+        m_destructors.clear();
+    }
+
+    void grow(const size_t min_num_bytes)
+    {
+        const size_t size = std::max(m_block_size, min_num_bytes);
+        auto buffer = new std::byte[size];
+        m_retired.push_back(m_buffer);
+        m_retired_used += static_cast<size_t>(m_offset - m_buffer);
+        m_retired_capacity += m_size;
+        m_size = size;
+        m_buffer = buffer;
+        m_offset = buffer;
+    }
+
     size_t m_size;
     std::byte* m_buffer;
     std::byte* m_offset;
+    size_t m_block_size;
+    std::vector<std::byte*> m_retired {};
+    size_t m_retired_used = 0;
+    size_t m_retired_capacity = 0;
+    size_t m_high_water = 0;
+    std::vector<Destructor> m_destructors {};
 };
\ No newline at end of file
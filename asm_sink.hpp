@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <streambuf>
+
+#include <unistd.h>
+
+#include "stats.hpp"
+
+// Stream buffer that drains generated assembly to a file descriptor through a
+// fixed-size buffer, so the program text never has to be held in memory.
+// Optionally counts instructions as the text passes through.
+class AsmFileBuf : public std::streambuf {
+public:
+    explicit AsmFileBuf(const int fd, AsmInstrCounter* counter = nullptr)
+        : m_fd(fd)
+        , m_counter(counter)
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    AsmFileBuf(const AsmFileBuf&) = delete;
+    AsmFileBuf& operator=(const AsmFileBuf&) = delete;
+
+    ~AsmFileBuf() override
+    {
+        drain();
+    }
+
+    [[nodiscard]] bool failed() const
+    {
+        return m_failed;
+    }
+
+protected:
+    int_type overflow(const int_type ch) override
+    {
+        if (!drain()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override
+    {
+        return drain() ? 0 : -1;
+    }
+
+private:
+    bool drain()
+    {
+        const char* data = pbase();
+        size_t size = pptr() - pbase();
+        if (m_counter != nullptr) {
+            m_counter->feed({ data, size });
+        }
+        while (size > 0 && !m_failed) {
+            const ssize_t written = write(m_fd, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                m_failed = true;
+                break;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+        return !m_failed;
+    }
+
+    int m_fd;
+    AsmInstrCounter* m_counter;
+    bool m_failed = false;
+    std::array<char, 64 * 1024> m_buffer {};
+};
@@ -0,0 +1,403 @@
+// Throughput benchmarks for the hydro compiler front end and code generator.
+//
+// Each shape synthesizes a .hy program and times Tokenizer::tokenize,
+// Parser::parse_prog and Generator::gen_prog on it (best of --reps runs).
+// Results can be saved as a baseline and later runs compared against it.
+// --lex-scaling instead measures Tokenizer::tokenize_parallel from 1 to
+// --threads threads on one large source. --hyc compares lexing and parsing
+// each shape with loading it back from a precompiled .hyc file.
+//
+//   g++ -std=c++20 -O2 -o bench_compiler bench_compiler.cpp
+//   ./bench_compiler --save-baseline bench_baseline.json
+//   ./bench_compiler --baseline bench_baseline.json
+//   ./bench_compiler --lex-scaling --scale 4 --threads 16
+//   ./bench_compiler --hyc
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "generation.hpp"
+#include "hyc.hpp"
+#include "stats.hpp"
+
+using json = nlohmann::json;
+
+struct Shape {
+    std::string name;
+    std::function<std::string(double scale)> generate;
+};
+
+static size_t scaled(const double base, const double scale)
+{
+    return std::max<size_t>(1, static_cast<size_t>(base * scale));
+}
+
+// `let v0 = 0; let v1 = 1; ...`
+static std::string gen_flat_let(const double scale)
+{
+    const size_t count = scaled(1'000'000, scale);
+    std::string src;
+    src.reserve(count * 24);
+    for (size_t i = 0; i < count; i++) {
+        src += "let v" + std::to_string(i) + " = " + std::to_string(i % 1000) + ";\n";
+    }
+    src += "exit(v0);\n";
+    return src;
+}
+
+// Repeated towers of nested scopes, each level declaring one variable.
+static std::string gen_nested_scopes(const double scale)
+{
+    const size_t towers = scaled(10'000, scale);
+    constexpr size_t depth = 64;
+    std::string src = "let d = 0;\n";
+    for (size_t t = 0; t < towers; t++) {
+        for (size_t level = 0; level < depth; level++) {
+            src += "{ let n" + std::to_string(level) + " = " + (level == 0 ? "d" : "n" + std::to_string(level - 1))
+                + " + 1;\n";
+        }
+        src += "d = n" + std::to_string(depth - 1) + ";\n";
+        src.append(depth, '}');
+        src += "\n";
+    }
+    src += "exit(d);\n";
+    return src;
+}
+
+// Long if/elif/else chains dispatching on one variable.
+static std::string gen_elif_chain(const double scale)
+{
+    const size_t chains = scaled(50, scale);
+    constexpr size_t length = 2000;
+    std::string src = "let x = 7;\nlet r = 0;\n";
+    for (size_t c = 0; c < chains; c++) {
+        src += "if (x - 0) { r = r + 1; }\n";
+        for (size_t i = 1; i < length; i++) {
+            src += "elif (x - " + std::to_string(i) + ") { r = r + " + std::to_string(i) + "; }\n";
+        }
+        src += "else { r = r - 1; }\n";
+    }
+    src += "exit(r);\n";
+    return src;
+}
+
+// Statements whose right-hand side is a long flat sum of products.
+static std::string gen_wide_arith(const double scale)
+{
+    const size_t stmts = scaled(4'000, scale);
+    constexpr size_t width = 256;
+    std::string src = "let a = 3;\nlet b = 5;\n";
+    for (size_t s = 0; s < stmts; s++) {
+        src += "a = a";
+        for (size_t i = 0; i < width; i++) {
+            src += (i % 2 == 0 ? " + b * " : " - a * ") + std::to_string(i % 7 + 1);
+        }
+        src += ";\n";
+    }
+    src += "exit(a);\n";
+    return src;
+}
+
+// Statements whose right-hand side is a deeply parenthesized expression.
+static std::string gen_deep_arith(const double scale)
+{
+    const size_t stmts = scaled(2'000, scale);
+    constexpr size_t depth = 500;
+    std::string src = "let a = 1;\n";
+    for (size_t s = 0; s < stmts; s++) {
+        src += "a = ";
+        src.append(depth, '(');
+        src += "a";
+        for (size_t i = 0; i < depth; i++) {
+            src += (i % 3 == 0 ? " * 2)" : " + 1)");
+        }
+        src += ";\n";
+    }
+    src += "exit(a);\n";
+    return src;
+}
+
+// Mostly comments, with one statement every few lines.
+static std::string gen_comment_heavy(const double scale)
+{
+    const size_t blocks = scaled(200'000, scale);
+    std::string src = "let c = 0;\n";
+    for (size_t b = 0; b < blocks; b++) {
+        src += "// line comment describing the next statement in some detail\n";
+        src += "/* a block comment\n   spanning two lines */\n";
+        src += "c = c + 1; // trailing comment\n";
+    }
+    src += "exit(c);\n";
+    return src;
+}
+
+struct Result {
+    size_t source_bytes = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+    size_t instructions = 0;
+    double tokenize_ms = 1e300;
+    double parse_ms = 1e300;
+    double generate_ms = 1e300;
+    double total_ms = 1e300;
+
+    [[nodiscard]] json to_json() const
+    {
+        return {
+            { "tokenize_ms", tokenize_ms },
+            { "parse_ms", parse_ms },
+            { "generate_ms", generate_ms },
+            { "total_ms", total_ms },
+            { "tokens_per_sec", tokens / (tokenize_ms / 1e3) },
+            { "nodes_per_sec", nodes / (parse_ms / 1e3) },
+            { "instructions_per_sec", instructions / (generate_ms / 1e3) },
+            { "source_mb_per_sec", source_bytes / 1e6 / (total_ms / 1e3) },
+        };
+    }
+};
+
+template <typename F>
+static double time_ms(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Result run_shape(const std::string& src, const int reps)
+{
+    Result result;
+    result.source_bytes = src.size();
+    for (int rep = 0; rep < reps; rep++) {
+        std::vector<Token> tokens;
+        std::optional<NodeProg> prog;
+        std::string assembly;
+        Tokenizer tokenizer(src);
+        const double tokenize_ms = time_ms([&] { tokens = tokenizer.tokenize(); });
+        result.tokens = tokens.size();
+        Parser parser(std::move(tokens));
+        const double parse_ms = time_ms([&] { prog = parser.parse_prog(); });
+        std::map<std::string, size_t> counts;
+        AstCounter { .counts = counts }(prog.value());
+        result.nodes = 0;
+        for (const auto& [kind, count] : counts) {
+            result.nodes += count;
+        }
+        Generator generator(prog.value());
+        const double generate_ms = time_ms([&] { assembly = generator.gen_prog(); });
+        AsmInstrCounter counter;
+        counter.feed(assembly);
+        result.instructions = counter.count();
+
+        result.tokenize_ms = std::min(result.tokenize_ms, tokenize_ms);
+        result.parse_ms = std::min(result.parse_ms, parse_ms);
+        result.generate_ms = std::min(result.generate_ms, generate_ms);
+        result.total_ms = std::min(result.total_ms, tokenize_ms + parse_ms + generate_ms);
+    }
+    return result;
+}
+
+// Tokenizer throughput on a mix of statements and line/block comments, from
+// one thread up to `max_threads`. Every parallel result is checked against the
+// sequential token stream.
+static int run_lex_scaling(const double scale, const int reps, const size_t max_threads)
+{
+    std::string src = gen_comment_heavy(scale) + gen_flat_let(scale);
+    const std::vector<Token> reference = Tokenizer(src).tokenize();
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(12) << "lex ms" << std::setw(12)
+              << "MB/s" << std::setw(12) << "speedup" << "\n";
+    double single_ms = 0;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        double best_ms = 1e300;
+        std::vector<Token> tokens;
+        for (int rep = 0; rep < reps; rep++) {
+            Tokenizer tokenizer(src);
+            best_ms = std::min(best_ms, time_ms([&] {
+                tokens = threads == 1 ? tokenizer.tokenize() : tokenizer.tokenize_parallel(threads);
+            }));
+        }
+        const bool same = std::ranges::equal(tokens, reference, [](const Token& a, const Token& b) {
+            return a.type == b.type && a.line == b.line && a.value == b.value;
+        });
+        if (!same) {
+            std::cerr << "Token stream with " << threads << " threads differs from the sequential one" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (threads == 1) {
+            single_ms = best_ms;
+        }
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << best_ms << std::setw(12) << src.size() / 1e6 / (best_ms / 1e3) << std::setw(11)
+                  << std::setprecision(2) << single_ms / best_ms << "x\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+// Front-end time per shape with and without a precompiled AST: lexing and
+// parsing the source versus mapping and loading the .hyc written from it.
+// Both programs must generate the same assembly.
+static int run_hyc(const std::vector<Shape>& shapes, const double scale, const int reps, const std::optional<std::string>& only)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_compiler.hyc").string();
+    std::cout << std::left << std::setw(16) << "shape" << std::right << std::setw(10) << "src MB" << std::setw(10)
+              << "hyc MB" << std::setw(14) << "lex+parse ms" << std::setw(12) << "load ms" << std::setw(12)
+              << "speedup" << "\n";
+    hyc::Reader reader;
+    for (const auto& [name, generate] : shapes) {
+        if (only.has_value() && only.value() != name) {
+            continue;
+        }
+        const std::string src = generate(scale);
+        double parse_ms = 1e300;
+        std::optional<NodeProg> parsed;
+        std::optional<Parser> parser;
+        for (int rep = 0; rep < reps; rep++) {
+            parse_ms = std::min(parse_ms, time_ms([&] {
+                parser.emplace(Tokenizer(src).tokenize());
+                parsed = parser->parse_prog();
+            }));
+        }
+        const std::string bytes = hyc::Writer().write(parsed.value());
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+        double load_ms = 1e300;
+        NodeProg loaded;
+        for (int rep = 0; rep < reps; rep++) {
+            load_ms = std::min(load_ms, time_ms([&] { loaded = reader.load_file(path); }));
+        }
+        if (Generator(parsed.value()).gen_prog() != Generator(loaded).gen_prog()) {
+            std::cerr << name << ": program loaded from .hyc generates different assembly" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << src.size() / 1e6 << std::setw(10) << bytes.size() / 1e6 << std::setw(14)
+                  << parse_ms << std::setw(12) << load_ms << std::setw(11) << std::setprecision(2)
+                  << parse_ms / load_ms << "x\n";
+    }
+    std::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
+
+static void print_row(const std::string& shape, const Result& r)
+{
+    std::cout << std::left << std::setw(16) << shape << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << r.source_bytes / 1e6 << std::setw(12) << r.tokenize_ms << std::setw(12)
+              << r.parse_ms << std::setw(12) << r.generate_ms << std::setw(12) << r.total_ms << std::setw(12)
+              << r.tokens / (r.tokenize_ms / 1e3) / 1e6 << std::setw(12) << r.nodes / (r.parse_ms / 1e3) / 1e6
+              << std::setw(12) << r.instructions / (r.generate_ms / 1e3) / 1e6 << "\n";
+}
+
+static void print_diff(const json& baseline, const json& current)
+{
+    std::cout << "\nChange versus baseline (positive = faster):\n";
+    for (const auto& [shape, metrics] : current.items()) {
+        if (!baseline.contains(shape)) {
+            continue;
+        }
+        for (const auto& [metric, value] : metrics.items()) {
+            if (!baseline[shape].contains(metric)) {
+                continue;
+            }
+            const double old_value = baseline[shape][metric].get<double>();
+            const double new_value = value.get<double>();
+            const bool lower_is_better = metric.ends_with("_ms");
+            const double change = lower_is_better ? (old_value / new_value - 1) : (new_value / old_value - 1);
+            std::cout << "  " << std::left << std::setw(16) << shape << std::setw(24) << metric << std::right
+                      << std::showpos << std::setw(10) << std::setprecision(1) << change * 100 << "%"
+                      << std::noshowpos << "  (" << old_value << " -> " << new_value << ")\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double scale = 1.0;
+    int reps = 3;
+    std::optional<std::string> only;
+    std::optional<std::string> baseline_path;
+    std::optional<std::string> save_path;
+    bool lex_scaling = false;
+    bool hyc = false;
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) {
+            scale = std::stod(argv[++i]);
+        }
+        else if (arg == "--reps" && i + 1 < argc) {
+            reps = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--only" && i + 1 < argc) {
+            only = argv[++i];
+        }
+        else if (arg == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        }
+        else if (arg == "--save-baseline" && i + 1 < argc) {
+            save_path = argv[++i];
+        }
+        else if (arg == "--lex-scaling") {
+            lex_scaling = true;
+        }
+        else if (arg == "--hyc") {
+            hyc = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            max_threads = std::max(1, std::stoi(argv[++i]));
+        }
+        else {
+            std::cerr << "bench_compiler [--scale <f>] [--reps <n>] [--only <shape>] [--baseline <file>] "
+                         "[--save-baseline <file>] [--lex-scaling [--threads <n>]] [--hyc]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (lex_scaling) {
+        return run_lex_scaling(scale, reps, max_threads);
+    }
+
+    const std::vector<Shape> shapes {
+        { "flat_let", gen_flat_let },         { "nested_scopes", gen_nested_scopes },
+        { "elif_chain", gen_elif_chain },     { "wide_arith", gen_wide_arith },
+        { "deep_arith", gen_deep_arith },     { "comment_heavy", gen_comment_heavy },
+    };
+    if (hyc) {
+        return run_hyc(shapes, scale, reps, only);
+    }
+
+
+    std::cout << std::left << std::setw(16) << "shape" << std::right << std::setw(10) << "src MB" << std::setw(12)
+              << "lex ms" << std::setw(12) << "parse ms" << std::setw(12) << "gen ms" << std::setw(12) << "total ms"
+              << std::setw(12) << "Mtok/s" << std::setw(12) << "Mnode/s" << std::setw(12) << "Minstr/s" << "\n";
+    json current;
+    for (const auto& [name, generate] : shapes) {
+        if (only.has_value() && only.value() != name) {
+            continue;
+        }
+        const Result result = run_shape(generate(scale), reps);
+        print_row(name, result);
+        current[name] = result.to_json();
+    }
+
+    if (baseline_path.has_value()) {
+        std::ifstream in(baseline_path.value());
+        if (!in.is_open()) {
+            std::cerr << "Could not open baseline: " << baseline_path.value() << std::endl;
+            return EXIT_FAILURE;
+        }
+        print_diff(json::parse(in), current);
+    }
+    if (save_path.has_value()) {
+        std::ofstream out(save_path.value());
+        out << current.dump(4) << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
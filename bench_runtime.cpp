@@ -0,0 +1,330 @@
+// Execution-cost harness for binaries produced by hydro.
+//
+// Every program in the corpus is compiled once per codegen mode, then each
+// executable is run --runs times. Cycles, instructions and branch misses are
+// read from perf_event_open counters attached to the child; where perf events
+// are unavailable (containers, perf_event_paranoid) only clock_gettime wall
+// time is reported. Exit codes are compared across modes so a miscompile shows
+// up next to the numbers. A few built-in programs are invalid and must be
+// rejected in every mode.
+//
+//   g++ -std=c++20 -O2 -o bench_runtime bench_runtime.cpp
+//   ./bench_runtime --hydro ./hydro [--mode name=flags]... [extra.hy]...
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Mode {
+    std::string name;
+    std::string flags;
+};
+
+struct Program {
+    std::string name;
+    std::string source;
+    bool invalid = false; // must fail to compile in every mode
+};
+
+struct Sample {
+    double wall_ms = 0;
+    std::optional<uint64_t> cycles;
+    std::optional<uint64_t> instructions;
+    std::optional<uint64_t> branch_misses;
+    int exit_code = -1;
+};
+
+// One hardware counter bound to a not-yet-exec'd child. Counting starts at exec.
+class PerfCounter {
+public:
+    PerfCounter(const pid_t pid, const uint64_t config)
+    {
+        perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.enable_on_exec = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0));
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter()
+    {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    [[nodiscard]] std::optional<uint64_t> read_value() const
+    {
+        uint64_t value = 0;
+        if (m_fd < 0 || read(m_fd, &value, sizeof(value)) != sizeof(value)) {
+            return {};
+        }
+        return value;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+static double now_ms()
+{
+    timespec ts {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static Sample run_once(const std::string& exe)
+{
+    int gate[2];
+    if (pipe(gate) != 0) {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+    const double start = now_ms();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // Hold the child until the parent has attached its counters.
+        close(gate[1]);
+        char go;
+        if (read(gate[0], &go, 1) != 1) {
+            _exit(127);
+        }
+        // Programs that print would otherwise interleave with the report.
+        // dup2 rather than freopen: closing the inherited stdio stream would
+        // flush a copy of the parent's pending report output.
+        const int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        execl(exe.c_str(), exe.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(gate[0]);
+    Sample sample;
+    {
+        const PerfCounter cycles(pid, PERF_COUNT_HW_CPU_CYCLES);
+        const PerfCounter instructions(pid, PERF_COUNT_HW_INSTRUCTIONS);
+        const PerfCounter branch_misses(pid, PERF_COUNT_HW_BRANCH_MISSES);
+        if (write(gate[1], "x", 1) != 1) {
+            perror("write");
+        }
+        close(gate[1]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        sample.wall_ms = now_ms() - start;
+        sample.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        sample.cycles = cycles.read_value();
+        sample.instructions = instructions.read_value();
+        sample.branch_misses = branch_misses.read_value();
+    }
+    return sample;
+}
+
+// Median per metric over the runs.
+static Sample summarize(std::vector<Sample> runs)
+{
+    const auto median = [&](auto member) {
+        std::ranges::sort(runs, [&](const Sample& a, const Sample& b) { return a.*member < b.*member; });
+        return runs[runs.size() / 2].*member;
+    };
+    Sample result;
+    result.wall_ms = median(&Sample::wall_ms);
+    result.cycles = median(&Sample::cycles);
+    result.instructions = median(&Sample::instructions);
+    result.branch_misses = median(&Sample::branch_misses);
+    result.exit_code = runs.front().exit_code;
+    return result;
+}
+
+static std::vector<Program> builtin_corpus()
+{
+    std::vector<Program> corpus;
+    {
+        std::string src = "let a = 3;\nlet b = 5;\nlet c = 7;\n";
+        for (int i = 0; i < 20'000; i++) {
+            src += "a = (a * b + c) - (b * " + std::to_string(i % 9 + 1) + ") + (a * b + c);\n";
+            src += "c = c + a - " + std::to_string(i % 13) + ";\n";
+        }
+        src += "exit(a + c);\n";
+        corpus.push_back({ "straight_arith", std::move(src) });
+    }
+    {
+        std::string src = "let x = 0;\nlet r = 0;\n";
+        for (int round = 0; round < 2000; round++) {
+            src += "x = " + std::to_string(round % 64) + ";\n";
+            src += "if (x == 0) { r = r + 1; }\n";
+            for (int k = 1; k < 64; k++) {
+                src += "elif (x == " + std::to_string(k) + ") { r = r + " + std::to_string(k) + "; }\n";
+            }
+            src += "else { r = r - 1; }\n";
+        }
+        src += "exit(r);\n";
+        corpus.push_back({ "elif_dispatch", std::move(src) });
+    }
+    {
+        std::string src = "let s = 1;\n";
+        for (int i = 0; i < 20'000; i++) {
+            src += "{ let t = s * 3; let u = t + 1; let dead = u * u; s = u - t + s; }\n";
+        }
+        src += "exit(s);\n";
+        corpus.push_back({ "scoped_temps", std::move(src) });
+    }
+    {
+        std::string src = "let p = 1;\n";
+        for (int i = 0; i < 20'000; i++) {
+            src += "p = p * 6364136223846793005 + " + std::to_string(i) + ";\nprint(p);\n";
+        }
+        src += "exit(p);\n";
+        corpus.push_back({ "print_heavy", std::move(src) });
+    }
+    {
+        std::string src = "let a[4096];\nlet b[4096];\nlet c[4096];\n";
+        for (int i = 0; i < 64; i++) {
+            src += "b[" + std::to_string(i * 61 % 4096) + "] = " + std::to_string(i + 1) + ";\n";
+        }
+        for (int i = 0; i < 2000; i++) {
+            src += "a = a + b;\nc = a - c + b;\n";
+        }
+        src += "exit(a[61] + c[122]);\n";
+        corpus.push_back({ "array_elementwise", std::move(src) });
+    }
+    {
+        // Array-seeded so that -O2's partial evaluation cannot fold the chain.
+        std::string src = "let z[2];\nz[0] = 3;\nz[1] = 5;\nlet a = z[0];\nlet b = z[1];\n";
+        for (int i = 0; i < 20'000; i++) {
+            src += "a = a * 15 + b * " + std::to_string(i % 7 + 2) + ";\n";
+            src += "b = (b - " + std::to_string(i % 5 + 1) + ") * 12 + a * 10;\n";
+        }
+        src += "exit(a + b);\n";
+        corpus.push_back({ "linear_shapes", std::move(src) });
+    }
+    {
+        // -O2 interprets each statement up to the division by zero and then
+        // rolls back the assignments it made, including ones to variables of
+        // scopes that have already closed.
+        std::string src = "let s = 1;\n";
+        for (int i = 0; i < 2000; i++) {
+            src += "{ let t = s + " + std::to_string(i) + "; t = t * 3; { let u = t; u = u + 1; s = u - t; } }\n";
+        }
+        src += "{ let z = s - 1; z = z + 0; { let w = 2; w = w * s; s = w / z; } }\n";
+        src += "exit(s);\n";
+        corpus.push_back({ "scoped_trap", std::move(src) });
+    }
+    // Errors in statements the optimizers would drop.
+    corpus.push_back({ "dup_let", "let a = 1;\nlet a = 2;\nexit(a);\n", true });
+    corpus.push_back({ "dead_undeclared", "let y = z;\nexit(0);\n", true });
+    corpus.push_back({ "undeclared_tail", "exit(0);\nlet q = w;\n", true });
+    return corpus;
+}
+
+static std::string fmt_counter(const std::optional<uint64_t>& value)
+{
+    return value.has_value() ? std::to_string(value.value()) : "n/a";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string hydro = "./hydro";
+    int runs = 10;
+    std::vector<Mode> modes;
+    std::vector<Program> corpus;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--hydro" && i + 1 < argc) {
+            hydro = argv[++i];
+        }
+        else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--mode" && i + 1 < argc) {
+            const std::string spec = argv[++i];
+            const size_t eq = spec.find('=');
+            modes.push_back({ spec.substr(0, eq), eq == std::string::npos ? "" : spec.substr(eq + 1) });
+        }
+        else if (!arg.starts_with("-")) {
+            std::ifstream in { std::string(arg) };
+            std::stringstream ss;
+            ss << in.rdbuf();
+            corpus.push_back({ std::filesystem::path(arg).stem().string(), ss.str() });
+        }
+        else {
+            std::cerr << "bench_runtime [--hydro <path>] [--runs <n>] [--mode name=flags]... [program.hy]..."
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (modes.empty()) {
+        modes = { { "O0", "-O0" }, { "O1", "-O1" }, { "O2", "-O2" } };
+    }
+    if (corpus.empty()) {
+        corpus = builtin_corpus();
+    }
+    hydro = std::filesystem::absolute(hydro).string();
+
+    const std::filesystem::path work = std::filesystem::temp_directory_path() / ("hydro-bench-" + std::to_string(getpid()));
+    std::filesystem::create_directories(work);
+
+    std::cout << std::left << std::setw(18) << "program" << std::setw(10) << "mode" << std::right << std::setw(10)
+              << "wall ms" << std::setw(14) << "cycles" << std::setw(14) << "instrs" << std::setw(12) << "br-miss"
+              << std::setw(10) << "speedup" << std::setw(6) << "exit" << "\n";
+    bool mismatch = false;
+    for (const auto& [name, source, invalid] : corpus) {
+        std::optional<Sample> reference;
+        for (const auto& [mode, flags] : modes) {
+            const std::filesystem::path dir = work / (name + "." + mode);
+            std::filesystem::create_directories(dir);
+            std::ofstream(dir / "prog.hy") << source;
+            const std::string cmd = "cd '" + dir.string() + "' && '" + hydro + "' --no-cache " + flags + " prog.hy"
+                + (invalid ? " 2>/dev/null" : "");
+            const bool compiled = system(cmd.c_str()) == 0;
+            if (invalid || !compiled) {
+                std::cout << std::left << std::setw(18) << name << std::setw(10) << mode
+                          << (compiled ? "accepted  MISMATCH" : invalid ? "rejected" : "compile failed") << "\n";
+                mismatch |= compiled == invalid;
+                continue;
+            }
+            std::vector<Sample> samples;
+            for (int run = 0; run < runs; run++) {
+                samples.push_back(run_once((dir / "out").string()));
+            }
+            const Sample s = summarize(std::move(samples));
+            if (!reference.has_value()) {
+                reference = s;
+            }
+            const bool same_exit = s.exit_code == reference->exit_code;
+            mismatch |= !same_exit;
+            const double speedup = s.cycles.has_value() && reference->cycles.has_value()
+                ? static_cast<double>(reference->cycles.value()) / static_cast<double>(s.cycles.value())
+                : reference->wall_ms / s.wall_ms;
+            std::cout << std::left << std::setw(18) << name << std::setw(10) << mode << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(10) << s.wall_ms << std::setw(14) << fmt_counter(s.cycles)
+                      << std::setw(14) << fmt_counter(s.instructions) << std::setw(12)
+                      << fmt_counter(s.branch_misses) << std::setw(9) << std::setprecision(2) << speedup << "x"
+                      << std::setw(6) << s.exit_code << (same_exit ? "" : "  MISMATCH") << "\n";
+        }
+    }
+    std::filesystem::remove_all(work);
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+// Identifies the compiler build. Every rebuild of hydro gets a new identity so
+// artifacts produced by an older code generator are never served from the cache.
+inline constexpr std::string_view hydro_version = "hydro 0.1.0 (" __DATE__ " " __TIME__ ")";
+
+// 128-bit FNV-1a over the cache key material.
+class CacheKey {
+public:
+    void update(const std::string_view bytes)
+    {
+        constexpr unsigned __int128 prime = (static_cast<unsigned __int128>(1) << 88) + 0x13b;
+        for (const char c : bytes) {
+            m_hash ^= static_cast<unsigned char>(c);
+            m_hash *= prime;
+        }
+        // Separate fields so that ("ab", "c") and ("a", "bc") hash differently.
+        m_hash ^= 0xff;
+        m_hash *= prime;
+    }
+
+    [[nodiscard]] std::string hex() const
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string out(32, '0');
+        unsigned __int128 h = m_hash;
+        for (int i = 31; i >= 0; i--) {
+            out[i] = digits[static_cast<int>(h & 0xf)];
+            h >>= 4;
+        }
+        return out;
+    }
+
+private:
+    unsigned __int128 m_hash = (static_cast<unsigned __int128>(0x6c62272e07bb0142) << 64) | 0x62b821756295c58d;
+};
+
+// On-disk, content-addressed store of finished build artifacts.
+//
+// Each entry is a directory named after the key holding the artifacts of one
+// compile. Entries are published with a single rename so a concurrent reader
+// sees either nothing or a complete entry. The directory mtime doubles as the
+// LRU timestamp and is refreshed on every hit.
+class CompileCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    CompileCache(std::filesystem::path root, const uint64_t max_bytes)
+        : m_root(std::move(root))
+        , m_max_bytes(max_bytes)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(m_root, ec);
+        m_usable = !ec;
+        if (!m_usable) {
+            std::cerr << "[Cache] Could not create " << m_root << ": " << ec.message() << std::endl;
+        }
+    }
+
+    static std::filesystem::path default_root()
+    {
+        if (const char* dir = std::getenv("HYDRO_CACHE_DIR")) {
+            return dir;
+        }
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+            return std::filesystem::path(xdg) / "hydro";
+        }
+        if (const char* home = std::getenv("HOME")) {
+            return std::filesystem::path(home) / ".cache" / "hydro";
+        }
+        return ".hydro-cache";
+    }
+
+    [[nodiscard]] bool usable() const
+    {
+        return m_usable;
+    }
+
+    // Copies the artifacts of `key` into their destinations. Returns false on a miss.
+    bool fetch(const std::string& key, const std::vector<std::filesystem::path>& artifacts)
+    {
+        if (!m_usable) {
+            return false;
+        }
+        const std::filesystem::path entry = m_root / key;
+        std::error_code ec;
+        if (!std::filesystem::is_directory(entry, ec)) {
+            bump(false);
+            return false;
+        }
+        for (const auto& artifact : artifacts) {
+            if (!install(entry / artifact.filename(), artifact)) {
+                bump(false);
+                return false;
+            }
+        }
+        std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+        bump(true);
+        return true;
+    }
+
+    void store(const std::string& key, const std::vector<std::filesystem::path>& artifacts)
+    {
+        if (!m_usable) {
+            return;
+        }
+        std::error_code ec;
+        const std::filesystem::path tmp = m_root / ("tmp." + key + "." + std::to_string(getpid()));
+        std::filesystem::create_directory(tmp, ec);
+        bool ok = !ec;
+        for (const auto& artifact : artifacts) {
+            if (!ok) {
+                break;
+            }
+            ok = std::filesystem::copy_file(artifact, tmp / artifact.filename(), ec);
+        }
+        // rename(2) onto an existing non-empty directory fails, which simply
+        // means a concurrent compile published the same entry first.
+        if (!ok || std::rename(tmp.c_str(), (m_root / key).c_str()) != 0) {
+            std::filesystem::remove_all(tmp, ec);
+            return;
+        }
+        evict(key);
+    }
+
+    [[nodiscard]] Stats stats() const
+    {
+        Stats stats;
+        std::ifstream in(m_root / "stats");
+        in >> stats.hits >> stats.misses;
+        return stats;
+    }
+
+private:
+    // Copies `from` next to `to` and renames it into place so a partially
+    // written artifact is never observable.
+    static bool install(const std::filesystem::path& from, const std::filesystem::path& to)
+    {
+        std::error_code ec;
+        std::filesystem::path tmp = to;
+        tmp += ".tmp." + std::to_string(getpid());
+        if (!std::filesystem::copy_file(from, tmp, std::filesystem::copy_options::overwrite_existing, ec)) {
+            return false;
+        }
+        if (std::rename(tmp.c_str(), to.c_str()) != 0) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void bump(const bool hit) const
+    {
+        const int lock = open((m_root / "lock").c_str(), O_RDWR | O_CREAT, 0644);
+        if (lock < 0) {
+            return;
+        }
+        flock(lock, LOCK_EX);
+        Stats current = stats();
+        (hit ? current.hits : current.misses)++;
+        {
+            std::ofstream out(m_root / "stats", std::ios::trunc);
+            out << current.hits << " " << current.misses << "\n";
+        }
+        flock(lock, LOCK_UN);
+        close(lock);
+    }
+
+    // A staging directory is published within one compile, so one this old
+    // was left by a compile that was killed before its rename.
+    static constexpr std::chrono::hours stale_tmp_age { 1 };
+
+    // Drops least recently used entries until the cache fits its budget. The
+    // entry that was just published is never evicted. Abandoned staging
+    // directories are removed along the way.
+    void evict(const std::string& keep) const
+    {
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type used;
+            uint64_t bytes;
+        };
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        std::error_code ec;
+        const auto now = std::filesystem::file_time_type::clock::now();
+        for (const auto& dirent : std::filesystem::directory_iterator(m_root, ec)) {
+            const std::string name = dirent.path().filename().string();
+            if (!dirent.is_directory(ec)) {
+                continue;
+            }
+            if (name.starts_with("tmp.")) {
+                if (now - dirent.last_write_time(ec) > stale_tmp_age && !ec) {
+                    std::filesystem::remove_all(dirent.path(), ec);
+                }
+                continue;
+            }
+            Entry entry { .path = dirent.path(), .used = dirent.last_write_time(ec), .bytes = 0 };
+            for (const auto& file : std::filesystem::directory_iterator(dirent.path(), ec)) {
+                entry.bytes += file.file_size(ec);
+            }
+            total += entry.bytes;
+            if (name != keep) {
+                entries.push_back(std::move(entry));
+            }
+        }
+        if (total <= m_max_bytes) {
+            return;
+        }
+        std::ranges::sort(entries, [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        for (const auto& entry : entries) {
+            if (total <= m_max_bytes) {
+                break;
+            }
+            std::filesystem::remove_all(entry.path, ec);
+            total -= entry.bytes;
+        }
+    }
+
+    std::filesystem::path m_root;
+    uint64_t m_max_bytes;
+    bool m_usable = false;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "driver.hpp"
+#include "server_protocol.hpp"
+
+// Long-lived `hydro --serve` process. Requests from hydro_client arrive on a
+// Unix domain socket and are compiled one at a time by a single Driver, so
+// the parser's arena is rewound instead of reallocated, its interning tables
+// keep their buckets and process startup is paid once. Each request runs in
+// the client's working directory with std::cerr captured for the reply;
+// nasm and ld still write their own diagnostics to the server's stderr.
+// Since requests are served one at a time, a client that stops sending or
+// reading is dropped after client_timeout_s rather than stalling the rest.
+class CompileServer {
+public:
+    explicit CompileServer(std::filesystem::path socket_path)
+        : m_socket_path(std::move(socket_path))
+    {
+    }
+
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+
+    ~CompileServer()
+    {
+        if (m_listen_fd >= 0) {
+            close(m_listen_fd);
+            unlink(m_socket_path.c_str());
+        }
+    }
+
+    // Serves until the process is killed. Returns only if the socket cannot be set up.
+    int run()
+    {
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        if (m_socket_path.native().size() >= sizeof(addr.sun_path)) {
+            std::cerr << "[Server] Socket path too long: " << m_socket_path.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::strcpy(addr.sun_path, m_socket_path.c_str());
+        // A client that hangs up before its reply must not take the server down.
+        signal(SIGPIPE, SIG_IGN);
+        m_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        unlink(m_socket_path.c_str());
+        if (m_listen_fd < 0 || bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || listen(m_listen_fd, SOMAXCONN) != 0) {
+            std::cerr << "[Server] Could not listen on " << m_socket_path.string() << ": " << std::strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cerr << "[Server] Listening on " << m_socket_path.string() << std::endl;
+        while (true) {
+            const int client = accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                if (errno != EINTR) {
+                    std::cerr << "[Server] accept: " << std::strerror(errno) << std::endl;
+                }
+                continue;
+            }
+            const timeval timeout { client_timeout_s, 0 };
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            serve(client);
+            close(client);
+        }
+    }
+
+private:
+    static constexpr time_t client_timeout_s = 10;
+
+    // Points std::cerr at a capture buffer for one request, and back again
+    // however the request ends.
+    class CerrCapture {
+    public:
+        explicit CerrCapture(std::ostringstream& capture)
+            : m_saved(std::cerr.rdbuf(capture.rdbuf()))
+        {
+        }
+
+        CerrCapture(const CerrCapture&) = delete;
+        CerrCapture& operator=(const CerrCapture&) = delete;
+
+        ~CerrCapture()
+        {
+            std::cerr.rdbuf(m_saved);
+        }
+
+    private:
+        std::streambuf* m_saved;
+    };
+
+    void serve(const int client)
+    {
+        namespace proto = server_protocol;
+        const std::optional<uint32_t> count = proto::read_u32(client);
+        if (!count.has_value() || count.value() == 0 || count.value() > proto::max_args) {
+            return;
+        }
+        std::vector<std::string> args;
+        for (uint32_t i = 0; i < count.value(); i++) {
+            std::optional<std::string> arg = proto::read_string(client);
+            if (!arg.has_value()) {
+                return;
+            }
+            args.push_back(std::move(arg.value()));
+        }
+        const std::string cwd = std::move(args.front());
+        args.erase(args.begin());
+
+        std::ostringstream diagnostics;
+        int status = EXIT_FAILURE;
+        {
+            const CerrCapture capture(diagnostics);
+            try {
+                if (chdir(cwd.c_str()) != 0) {
+                    std::cerr << "[Server] Could not enter " << cwd << ": " << std::strerror(errno) << std::endl;
+                }
+                else if (const std::optional<DriverOptions> opts = parse_args(args)) {
+                    status = m_driver.compile(opts.value());
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[Server] Internal error: " << e.what() << std::endl;
+                status = EXIT_FAILURE;
+            }
+        }
+
+        proto::write_string(client, diagnostics.str());
+        proto::write_u32(client, static_cast<uint32_t>(status));
+    }
+
+    std::filesystem::path m_socket_path;
+    int m_listen_fd = -1;
+    Driver m_driver {};
+};
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+
+#include "asm_sink.hpp"
+#include "cache.hpp"
+#include "generation.hpp"
+#include "hyc.hpp"
+#include "optimizer.hpp"
+#include "stats.hpp"
+
+inline void usage()
+{
+    std::cerr << "Incorrect usage. Correct usage is..." << std::endl;
+    std::cerr << "hydro [--no-cache] [--cache-dir <dir>] [--cache-max-size <bytes>] [--cache-stats]" << std::endl;
+    std::cerr << "      [--time-passes] [--stats-json <file>] [-g] [-O0|-O1|-O2] [--lex-threads <n>]" << std::endl;
+    std::cerr << "      [--profile-generate[=<file>]] [--profile-use=<file>] [--emit-hyc <file>] <input.hy|input.hyc>"
+              << std::endl;
+    std::cerr << "      [--watch]" << std::endl;
+    std::cerr << "hydro --serve [--socket <path>]" << std::endl;
+}
+
+// Everything the command line says about one compile.
+struct DriverOptions {
+    std::string input_path;
+    bool use_cache = true;
+    bool print_cache_stats = false;
+    bool time_passes = false;
+    std::optional<std::string> stats_json_path;
+    bool debug_info = false;
+    int opt_level = 0;
+    size_t lex_threads = 0; // 0: decide from the source size
+    std::optional<std::string> profile_generate;
+    std::optional<std::string> profile_use;
+    std::optional<std::string> emit_hyc;
+    bool watch = false; // rebuild on every save (see WatchSession)
+    std::filesystem::path cache_dir = CompileCache::default_root();
+    uint64_t cache_max_bytes = 256ull * 1024 * 1024;
+};
+
+// Parses the compile flags (argv without the program name). Prints the usage
+// and returns nothing if they are malformed.
+inline std::optional<DriverOptions> parse_args(const std::vector<std::string>& args)
+{
+    DriverOptions opts;
+    std::optional<std::string> input_path;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string_view arg = args[i];
+        const bool has_value = i + 1 < args.size();
+        if (arg == "--no-cache") {
+            opts.use_cache = false;
+        }
+        else if (arg == "--cache-stats") {
+            opts.print_cache_stats = true;
+        }
+        else if (arg == "-g") {
+            opts.debug_info = true;
+        }
+        else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+            opts.opt_level = arg[2] - '0';
+        }
+        else if (arg == "--profile-generate") {
+            opts.profile_generate = "hydro.prof";
+        }
+        else if (arg.starts_with("--profile-generate=")) {
+            opts.profile_generate = arg.substr(std::string_view("--profile-generate=").size());
+        }
+        else if (arg.starts_with("--profile-use=")) {
+            opts.profile_use = arg.substr(std::string_view("--profile-use=").size());
+        }
+        else if (arg == "--watch") {
+            opts.watch = true;
+        }
+        else if (arg == "--time-passes") {
+            opts.time_passes = true;
+        }
+        else if (arg == "--lex-threads" && has_value) {
+            opts.lex_threads = std::strtoull(args[++i].c_str(), nullptr, 10);
+        }
+        else if (arg == "--stats-json" && has_value) {
+            opts.stats_json_path = args[++i];
+        }
+        else if (arg == "--emit-hyc" && has_value) {
+            opts.emit_hyc = args[++i];
+        }
+        else if (arg == "--cache-dir" && has_value) {
+            opts.cache_dir = args[++i];
+        }
+        else if (arg == "--cache-max-size" && has_value) {
+            opts.cache_max_bytes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        }
+        else if (!arg.starts_with("-") && !input_path.has_value()) {
+            input_path = arg;
+        }
+        else {
+            usage();
+            return {};
+        }
+    }
+    if (!input_path.has_value()) {
+        usage();
+        return {};
+    }
+    opts.input_path = std::move(input_path.value());
+    return opts;
+}
+
+// Compiles one source file into out.asm, out.o and out in the working
+// directory. State that is worth keeping between compiles (the parser with
+// its arena and interning tables, the open cache) lives in the Driver, so the
+// compile server runs every request through the same one.
+class Driver {
+public:
+    // Returns the exit status of the compile. Diagnostics go to std::cerr.
+    int compile(const DriverOptions& opts)
+    {
+        try {
+            return run(opts);
+        }
+        catch (const CompileError&) {
+            return EXIT_FAILURE;
+        }
+    }
+
+private:
+    int run(const DriverOptions& opts)
+    {
+        CompileStats stats(opts.time_passes || opts.stats_json_path.has_value());
+        const auto report_stats = [&] {
+            if (!stats.enabled()) {
+                return;
+            }
+            rusage usage {};
+            getrusage(RUSAGE_SELF, &usage);
+            stats.set("peak rss kib", static_cast<uint64_t>(usage.ru_maxrss));
+            if (opts.time_passes) {
+                stats.print(std::cerr);
+            }
+            if (opts.stats_json_path.has_value()) {
+                std::fstream file(opts.stats_json_path.value(), std::ios::out);
+                file << stats.to_json().dump(4) << std::endl;
+            }
+        };
+
+        // A precompiled AST is mapped rather than read and skips lexing and parsing.
+        const bool precompiled = opts.input_path.ends_with(".hyc");
+        std::optional<hyc::MappedFile> mapped;
+        std::string contents = stats.time("read", [&] {
+            if (precompiled) {
+                mapped.emplace(opts.input_path);
+                return std::string();
+            }
+            std::stringstream contents_stream;
+            std::fstream input(opts.input_path, std::ios::in);
+            contents_stream << input.rdbuf();
+            return contents_stream.str();
+        });
+        const std::span<const std::byte> hyc_bytes = precompiled ? mapped->bytes() : std::span<const std::byte> {};
+        if (stats.enabled()) {
+            stats.set("source bytes", precompiled ? hyc_bytes.size() : contents.size());
+        }
+
+        GenOptions gen_options;
+        gen_options.opt_level = opts.opt_level;
+        // A .hyc points its line info at the source it was written from,
+        // which is only known once it is loaded (and is part of its bytes).
+        if (opts.debug_info && !precompiled) {
+            gen_options.debug_source = std::filesystem::absolute(opts.input_path).string();
+        }
+        gen_options.profile_generate = opts.profile_generate;
+        if (opts.profile_use.has_value()) {
+            std::ifstream profile(opts.profile_use.value(), std::ios::binary);
+            if (!profile.is_open()) {
+                std::cerr << "[Profile] Could not open " << opts.profile_use.value() << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::vector<uint64_t> counts;
+            uint64_t count;
+            while (profile.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+                counts.push_back(count);
+            }
+            gen_options.profile_use = std::move(counts);
+        }
+
+        const std::string assemble_cmd = opts.debug_info ? "nasm -felf64 -g -F dwarf out.asm" : "nasm -felf64 out.asm";
+        const std::string link_cmd = "ld -o out out.o";
+        const std::vector<std::filesystem::path> artifacts { "out.asm", "out.o", "out" };
+
+        CompileCache* cache = nullptr;
+        std::string key;
+        if (opts.use_cache) {
+            cache = &open_cache(opts.cache_dir, opts.cache_max_bytes);
+            CacheKey hasher;
+            hasher.update(hydro_version);
+            hasher.update(assemble_cmd);
+            hasher.update(link_cmd);
+            hasher.update(std::to_string(gen_options.opt_level));
+            hasher.update(gen_options.debug_source.value_or(""));
+            hasher.update(gen_options.profile_generate.value_or(""));
+            if (gen_options.profile_use.has_value()) {
+                const std::vector<uint64_t>& counts = gen_options.profile_use.value();
+                hasher.update({ reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(uint64_t) });
+            }
+            hasher.update(precompiled ? std::string_view(reinterpret_cast<const char*>(hyc_bytes.data()), hyc_bytes.size())
+                                      : std::string_view(contents));
+            key = hasher.hex();
+        }
+        const auto report_cache = [&] {
+            if (opts.print_cache_stats && cache != nullptr) {
+                const auto [hits, misses] = cache->stats();
+                std::cerr << "[Cache] hits: " << hits << " misses: " << misses << std::endl;
+            }
+        };
+
+        // The .hyc comes from the parsed tree, which a cache hit skips, so
+        // --emit-hyc always compiles (and still refreshes the cache entry).
+        if (cache != nullptr && !opts.emit_hyc.has_value()
+            && stats.time("cache lookup", [&] { return cache->fetch(key, artifacts); })) {
+            report_cache();
+            report_stats();
+            return EXIT_SUCCESS;
+        }
+
+        const ParseOptions parse_options { .hash_cons = opts.opt_level >= 1 };
+        std::optional<NodeProg> prog;
+        if (precompiled) {
+            prog = stats.time("load hyc", [&] { return m_hyc.load(hyc_bytes, parse_options); });
+            mapped.reset();
+            if (opts.debug_info) {
+                if (!m_hyc.source_path().has_value()) {
+                    std::cerr << "[hyc] " << opts.input_path << " does not record its source path, which -g needs" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                gen_options.debug_source = m_hyc.source_path();
+            }
+            if (stats.enabled()) {
+                stats.count_ast(prog.value());
+                stats.set("arena bytes", m_hyc.allocator().used());
+            }
+        }
+        else {
+            prog = lex_and_parse(std::move(contents), opts, parse_options, stats);
+            if (!prog.has_value()) {
+                std::cerr << "Invalid program" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Written before the optimizer rewrites the tree, so the file does not
+        // depend on the optimization level it was produced at.
+        if (opts.emit_hyc.has_value()) {
+            const std::optional<std::string> source_path
+                = precompiled ? m_hyc.source_path() : std::filesystem::absolute(opts.input_path).string();
+            const std::string bytes = stats.time("emit hyc", [&] { return hyc::Writer().write(prog.value(), source_path); });
+            std::ofstream file(opts.emit_hyc.value(), std::ios::binary | std::ios::trunc);
+            if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) || !file.flush()) {
+                std::cerr << "Could not write " << opts.emit_hyc.value() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        // The optimizers below may drop the statement that -O0's code generator
+        // would have rejected, so the checks run on the tree as parsed.
+        stats.time("check names", [&] { NameChecker().run(prog.value()); });
+
+        PartialEvaluator peval;
+        if (opts.opt_level >= 2 && !opts.profile_generate.has_value()) {
+            const bool complete = stats.time("partial evaluation", [&] { return peval.run(prog.value()); });
+            if (stats.enabled()) {
+                stats.set("peval folded statements", peval.folded_stmts());
+                stats.set("peval complete", complete ? 1 : 0);
+            }
+        }
+
+        if (opts.opt_level >= 1) {
+            // Measured against plain codegen so that profile options do not skew the counts.
+            const GenOptions plain { .opt_level = opts.opt_level };
+            size_t nodes_before = 0;
+            size_t instrs_before = 0;
+            if (stats.enabled()) {
+                nodes_before = ast_node_count(prog.value());
+                instrs_before = asm_instr_count(prog.value(), plain);
+            }
+            DeadCodeEliminator dce;
+            stats.time("dead code elimination", [&] { dce.run(prog.value()); });
+            if (stats.enabled()) {
+                stats.set("dce removed statements", dce.removed_stmts());
+                stats.set("dce removed ast nodes", nodes_before - ast_node_count(prog.value()));
+                const size_t instrs_after = asm_instr_count(prog.value(), plain);
+                stats.set("dce removed instructions", instrs_before - std::min(instrs_before, instrs_after));
+            }
+        }
+
+        {
+            const int fd = open("out.asm", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                std::cerr << "out.asm: " << std::strerror(errno) << std::endl;
+                return EXIT_FAILURE;
+            }
+            AsmInstrCounter counter;
+            AsmFileBuf buf(fd, stats.enabled() ? &counter : nullptr);
+            std::ostream out(&buf);
+            Generator generator(prog.value(), gen_options);
+            try {
+                stats.time("generate", [&] {
+                    generator.gen_prog(out);
+                    out.flush();
+                });
+            }
+            catch (const CompileError&) {
+                close(fd);
+                throw;
+            }
+            const bool failed = buf.failed() || close(fd) != 0;
+            if (failed) {
+                std::cerr << "Could not write out.asm" << std::endl;
+                return EXIT_FAILURE;
+            }
+            if (stats.enabled()) {
+                stats.set("instructions", counter.count());
+            }
+        }
+
+        if (stats.time("assemble", [&] { return system(assemble_cmd.c_str()); }) != 0
+            || stats.time("link", [&] { return system(link_cmd.c_str()); }) != 0) {
+            std::cerr << "Assembling or linking failed" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (cache != nullptr) {
+            stats.time("cache store", [&] { cache->store(key, artifacts); });
+        }
+        report_cache();
+        report_stats();
+
+        return EXIT_SUCCESS;
+    }
+
+    std::optional<NodeProg> lex_and_parse(std::string contents,
+                                          const DriverOptions& opts,
+                                          const ParseOptions parse_options,
+                                          CompileStats& stats)
+    {
+        size_t lex_threads = opts.lex_threads;
+        if (lex_threads == 0) {
+            constexpr size_t parallel_lex_bytes = 8 * 1024 * 1024;
+            lex_threads = contents.size() >= parallel_lex_bytes ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+        }
+        Tokenizer tokenizer(std::move(contents));
+        std::vector<Token> tokens = stats.time("tokenize", [&] {
+            return lex_threads > 1 ? tokenizer.tokenize_parallel(lex_threads) : tokenizer.tokenize();
+        });
+        if (stats.enabled()) {
+            stats.set("tokens", tokens.size());
+        }
+
+        if (m_parser.has_value()) {
+            m_parser->reset(std::move(tokens), parse_options);
+        }
+        else {
+            m_parser.emplace(std::move(tokens), parse_options);
+        }
+        Parser& parser = m_parser.value();
+        std::optional<NodeProg> prog = stats.time("parse", [&] { return parser.parse_prog(); });
+        if (prog.has_value() && stats.enabled()) {
+            stats.count_ast(prog.value());
+            stats.set("arena bytes", parser.allocator().used());
+            stats.set("arena high-water bytes", parser.allocator().high_water());
+            stats.set("arena capacity bytes", parser.allocator().capacity());
+        }
+        return prog;
+    }
+
+    CompileCache& open_cache(const std::filesystem::path& dir, const uint64_t max_bytes)
+    {
+        // Absolute, since the compile server changes directory per request.
+        const std::filesystem::path root = std::filesystem::absolute(dir);
+        if (!m_cache.has_value() || m_cache_dir != root || m_cache_max_bytes != max_bytes) {
+            m_cache.emplace(root, max_bytes);
+            m_cache_dir = root;
+            m_cache_max_bytes = max_bytes;
+        }
+        return m_cache.value();
+    }
+
+    std::optional<Parser> m_parser {};
+    hyc::Reader m_hyc {};
+    std::optional<CompileCache> m_cache {};
+    std::filesystem::path m_cache_dir {};
+    uint64_t m_cache_max_bytes = 0;
+};
@@ -2,14 +2,258 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <span>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "parser.hpp"
+#include "superopt_table.hpp"
+
+struct GenOptions {
+    // 0 emits the straightforward stack-machine code; 1 enables the
+    // optimizations that do not need profile data: jump tables for constant
+    // dispatch and, given a hash-consed AST (ParseOptions::hash_cons),
+    // common subexpression elimination. 2 additionally has the driver evaluate
+    // the program at compile time (PartialEvaluator) before codegen, and
+    // lowers multiplications by constants and a few linear shapes with the
+    // superoptimizer's sequences (superopt_table.hpp).
+    int opt_level = 0;
+    // When set, every statement and expression is preceded by a %line
+    // directive naming its line in this file, so `nasm -g -F dwarf` emits a
+    // DWARF line table that maps instructions back to the .hy source.
+    std::optional<std::string> debug_source {};
+    // When set, every scope and every fall-through of an if chain without an
+    // else gets a counter, and the binary writes the counters to this path on
+    // exit (see --profile-generate).
+    std::optional<std::string> profile_generate {};
+    // Counters from a previous instrumented run. If/elif chains are laid out
+    // so that their most frequent outcome is the fall-through path.
+    std::optional<std::vector<uint64_t>> profile_use {};
+};
+
+// The name, scope and array checks Generator makes while emitting code, as a
+// pass of their own. The optimizers rewrite and drop statements before code
+// generation, so the driver runs this on the tree as parsed at every level;
+// otherwise -O1 and -O2 would accept programs -O0 rejects (an undeclared name
+// in a dead `let`, a duplicate `let` whose first value is never read).
+// Statements and operands are visited in the generator's order and errors use
+// its messages, so the first error reported is the same at every level.
+class NameChecker {
+public:
+    void run(const NodeProg& prog)
+    {
+        for (const NodeStmt* stmt : prog.stmts) {
+            check_stmt(stmt);
+        }
+    }
+
+private:
+    void check_stmt(const NodeStmt* stmt) // NOLINT(*-no-recursion)
+    {
+        if (const auto stmt_exit = std::get_if<NodeStmtExit*>(&stmt->var)) {
+            check_value((*stmt_exit)->expr);
+        }
+        else if (const auto stmt_print = std::get_if<NodeStmtPrint*>(&stmt->var)) {
+            check_value((*stmt_print)->expr);
+        }
+        else if (const auto let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            declare((*let)->ident.value.value(), 0);
+            check_value((*let)->expr);
+        }
+        else if (const auto let_array = std::get_if<NodeStmtLetArray*>(&stmt->var)) {
+            declare((*let_array)->ident.value.value(), (*let_array)->length);
+        }
+        else if (const auto assign = std::get_if<NodeStmtAssign*>(&stmt->var)) {
+            const std::string& name = (*assign)->ident.value.value();
+            const auto it = m_vars.find(name);
+            if (it == m_vars.end()) {
+                std::cerr << "Undeclared identifier: " << name << std::endl;
+                compile_error();
+            }
+            if (it->second != 0) {
+                check_array_expr((*assign)->expr, it->second);
+            }
+            else {
+                check_value((*assign)->expr);
+            }
+        }
+        else if (const auto assign_index = std::get_if<NodeStmtAssignIndex*>(&stmt->var)) {
+            check_index((*assign_index)->ident.value.value(), (*assign_index)->index);
+            check_value((*assign_index)->expr);
+        }
+        else if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+            check_scope(*scope);
+        }
+        else {
+            const NodeStmtIf* stmt_if = std::get<NodeStmtIf*>(stmt->var);
+            check_value(stmt_if->expr);
+            check_scope(stmt_if->scope);
+            std::optional<NodeIfPred*> pred = stmt_if->pred;
+            while (pred.has_value()) {
+                if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                    check_value((*elif)->expr);
+                    check_scope((*elif)->scope);
+                    pred = (*elif)->pred;
+                }
+                else {
+                    check_scope(std::get<NodeIfPredElse*>(pred.value()->var)->scope);
+                    pred.reset();
+                }
+            }
+        }
+    }
+
+    void check_scope(const NodeScope* scope) // NOLINT(*-no-recursion)
+    {
+        const size_t declared = m_order.size();
+        for (const NodeStmt* stmt : scope->stmts) {
+            check_stmt(stmt);
+        }
+        while (m_order.size() > declared) {
+            m_vars.erase(m_order.back());
+            m_order.pop_back();
+        }
+    }
+
+    // An expression producing one value: no array may appear except indexed.
+    void check_value(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                const std::string& name = (*ident)->ident.value.value();
+                const auto it = m_vars.find(name);
+                if (it == m_vars.end()) {
+                    std::cerr << "Undeclared identifier: " << name << std::endl;
+                    compile_error();
+                }
+                if (it->second != 0) {
+                    std::cerr << "Array used as a value: " << name << std::endl;
+                    compile_error();
+                }
+            }
+            else if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                check_index((*index)->ident.value.value(), (*index)->index);
+            }
+            else if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+                check_value((*paren)->expr);
+            }
+            return;
+        }
+        std::visit(
+            [&](const auto* op) {
+                check_value(op->rhs);
+                check_value(op->lhs);
+            },
+            std::get<NodeBinExpr*>(expr->var)->var);
+    }
+
+    // An element of array `name`. A constant index must be in bounds (-O1
+    // folds it into an address); indices computed at run time are not checked.
+    void check_index(const std::string& name, const NodeExpr* index) // NOLINT(*-no-recursion)
+    {
+        const size_t length = array_length(name);
+        const auto term = std::get_if<NodeTerm*>(&strip_parens(index)->var);
+        const auto int_lit = term == nullptr ? nullptr : std::get_if<NodeTermIntLit*>(&(*term)->var);
+        if (int_lit == nullptr) {
+            check_value(index);
+        }
+        else if ((*int_lit)->value >= length) {
+            std::cerr << "Array index out of bounds: " << name << "[" << (*int_lit)->value << "]" << std::endl;
+            compile_error();
+        }
+    }
+
+    // Whole arrays of `length` elements combined with + and -.
+    void check_array_expr(const NodeExpr* expr, const size_t length) // NOLINT(*-no-recursion)
+    {
+        expr = strip_parens(expr);
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var);
+            if (ident == nullptr) {
+                std::cerr << "Only arrays can be combined into an array" << std::endl;
+                compile_error();
+            }
+            const std::string& name = (*ident)->ident.value.value();
+            const size_t actual = array_length(name);
+            if (actual != length) {
+                std::cerr << "Array length mismatch: " << name << " has " << actual << " elements, " << length
+                          << " expected" << std::endl;
+                compile_error();
+            }
+            return;
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        const auto add = std::get_if<NodeBinExprAdd*>(&bin->var);
+        const auto sub = std::get_if<NodeBinExprSub*>(&bin->var);
+        if (add == nullptr && sub == nullptr) {
+            std::cerr << "Only + and - apply to whole arrays" << std::endl;
+            compile_error();
+        }
+        check_array_expr(add != nullptr ? (*add)->lhs : (*sub)->lhs, length);
+        check_array_expr(add != nullptr ? (*add)->rhs : (*sub)->rhs, length);
+    }
+
+    void declare(const std::string& name, const size_t length)
+    {
+        if (m_vars.contains(name)) {
+            std::cerr << "Identifier already used: " << name << std::endl;
+            compile_error();
+        }
+        m_vars.emplace(name, length);
+        m_order.push_back(name);
+    }
+
+    size_t array_length(const std::string& name) const
+    {
+        const auto it = m_vars.find(name);
+        if (it == m_vars.end()) {
+            std::cerr << "Undeclared identifier: " << name << std::endl;
+            compile_error();
+        }
+        if (it->second == 0) {
+            std::cerr << "Not an array: " << name << std::endl;
+            compile_error();
+        }
+        return it->second;
+    }
+
+    static const NodeExpr* strip_parens(const NodeExpr* expr)
+    {
+        while (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            const auto paren = std::get_if<NodeTermParen*>(&(*term)->var);
+            if (paren == nullptr) {
+                break;
+            }
+            expr = (*paren)->expr;
+        }
+        return expr;
+    }
+
+    std::unordered_map<std::string_view, size_t> m_vars {}; // name -> array length, 0 for a scalar
+    std::vector<std::string_view> m_order {}; // declaration order, for closing scopes
+};
 
 class Generator {
 public:
-    explicit Generator(NodeProg prog)
+    explicit Generator(NodeProg prog, GenOptions options = {})
         : m_prog(std::move(prog))
+        , m_options(std::move(options))
     {
+        if (m_options.profile_generate.has_value() || m_options.profile_use.has_value()) {
+            number_profile_slots(m_prog.stmts);
+        }
+        m_uses_print = uses_print(m_prog.stmts);
+        if (m_options.profile_use.has_value()) {
+            const std::vector<uint64_t>& counts = m_options.profile_use.value();
+            if (counts.size() == m_profile_slots.size() + 1 && counts.front() == m_profile_shape) {
+                m_profile = counts;
+            }
+            else {
+                std::cerr << "[Profile] Profile does not match this program; ignoring it" << std::endl;
+            }
+        }
     }
 
     void gen_term(const NodeTerm* term)
@@ -25,15 +269,9 @@ public:
 
             void operator()(const NodeTermIdent* term_ident) const
             {
-                const auto it = std::ranges::find_if(std::as_const(gen.m_vars), [&](const Var& var) {
-                    return var.name == term_ident->ident.value.value();
-                });
-                if (it == gen.m_vars.cend()) {
-                    std::cerr << "Undeclared identifier: " << term_ident->ident.value.value() << std::endl;
-                    exit(EXIT_FAILURE);
-                }
+                const Var& var = gen.scalar_var(term_ident->ident.value.value());
                 std::stringstream offset;
-                offset << "QWORD [rsp + " << (gen.m_stack_size - it->stack_loc - 1) * 8 << "]";
+                offset << "QWORD [rsp + " << (gen.m_stack_size - var.stack_loc - 1) * 8 << "]";
                 gen.push(offset.str());
             }
 
@@ -41,6 +279,14 @@ public:
             {
                 gen.gen_expr(term_paren->expr);
             }
+
+            void operator()(const NodeTermIndex* term_index) const
+            {
+                const Var& var = gen.array_var(term_index->ident.value.value());
+                gen.gen_expr(term_index->index);
+                gen.pop("rax");
+                gen.push("QWORD [rsp + rax * 8 + " + std::to_string(gen.array_offset(var)) + "]");
+            }
         };
         TermVisitor visitor({ .gen = *this });
         std::visit(visitor, term->var);
@@ -87,9 +333,22 @@ public:
                 gen.gen_expr(div->lhs);
                 gen.pop("rax");
                 gen.pop("rbx");
+                gen.m_output << "    xor rdx, rdx\n";
                 gen.m_output << "    div rbx\n";
                 gen.push("rax");
             }
+
+            void operator()(const NodeBinExprEq* eq) const
+            {
+                gen.gen_expr(eq->rhs);
+                gen.gen_expr(eq->lhs);
+                gen.pop("rax");
+                gen.pop("rbx");
+                gen.m_output << "    cmp rax, rbx\n";
+                gen.m_output << "    sete al\n";
+                gen.m_output << "    movzx rax, al\n";
+                gen.push("rax");
+            }
         };
 
         BinExprVisitor visitor { .gen = *this };
@@ -98,6 +357,20 @@ public:
 
     void gen_expr(const NodeExpr* expr)
     {
+        if (!m_cse.empty()) {
+            if (const auto it = m_cse.find(expr); it != m_cse.end()) {
+                push("QWORD [rsp + " + std::to_string((m_stack_size - it->second - 1) * 8) + "]");
+                return;
+            }
+        }
+        if (m_options.opt_level >= 1) {
+            // A hash-consed expression carries the line of its first
+            // occurrence, so at -O1 only statements go into the line table.
+            gen_acc(expr);
+            push("rax");
+            return;
+        }
+        emit_line(expr->line);
         struct ExprVisitor {
             Generator& gen;
 
@@ -116,15 +389,47 @@ public:
         std::visit(visitor, expr->var);
     }
 
+    // Evaluates `expr` into rax.
+    void gen_expr_rax(const NodeExpr* expr)
+    {
+        if (m_options.opt_level >= 1) {
+            gen_acc(expr);
+            return;
+        }
+        gen_expr(expr);
+        pop("rax");
+    }
+
     void gen_scope(const NodeScope* scope)
     {
         begin_scope();
-        for (const NodeStmt* stmt : scope->stmts) {
-            gen_stmt(stmt);
-        }
+        emit_profile_counter(scope);
+        gen_stmts(scope->stmts);
         end_scope();
     }
 
+    // At -O1 every maximal run of let/assign/exit/print statements is treated as a
+    // basic block for common subexpression elimination.
+    void gen_stmts(const std::vector<NodeStmt*>& stmts) // NOLINT(*-no-recursion)
+    {
+        const auto straight_line = [](const NodeStmt* stmt) {
+            return !std::holds_alternative<NodeScope*>(stmt->var) && !std::holds_alternative<NodeStmtIf*>(stmt->var);
+        };
+        size_t begin = 0;
+        while (begin < stmts.size()) {
+            if (m_options.opt_level < 1 || !straight_line(stmts[begin])) {
+                gen_stmt(stmts[begin++]);
+                continue;
+            }
+            size_t end = begin;
+            while (end < stmts.size() && straight_line(stmts[end])) {
+                end++;
+            }
+            gen_block({ stmts.data() + begin, end - begin });
+            begin = end;
+        }
+    }
+
     void gen_if_pred(const NodeIfPred* pred, const std::string& end_label)
     {
         struct PredVisitor {
@@ -134,15 +439,14 @@ public:
             void operator()(const NodeIfPredElif* elif) const
             {
                 gen.m_output << "    ;; elif\n";
-                gen.gen_expr(elif->expr);
-                gen.pop("rax");
+                gen.gen_expr_rax(elif->expr);
                 const std::string label = gen.create_label();
                 gen.m_output << "    test rax, rax\n";
                 gen.m_output << "    jz " << label << "\n";
                 gen.gen_scope(elif->scope);
                 gen.m_output << "    jmp " << end_label << "\n";
+                gen.m_output << label << ":\n";
                 if (elif->pred.has_value()) {
-                    gen.m_output << label << ":\n";
                     gen.gen_if_pred(elif->pred.value(), end_label);
                 }
             }
@@ -160,48 +464,94 @@ public:
 
     void gen_stmt(const NodeStmt* stmt)
     {
+        emit_line(stmt->line);
         struct StmtVisitor {
             Generator& gen;
 
             void operator()(const NodeStmtExit* stmt_exit) const
             {
                 gen.m_output << "    ;; exit\n";
-                gen.gen_expr(stmt_exit->expr);
-                gen.m_output << "    mov rax, 60\n";
-                gen.pop("rdi");
-                gen.m_output << "    syscall\n";
+                const auto term = std::get_if<NodeTerm*>(&stmt_exit->expr->var);
+                const auto int_lit = term == nullptr ? nullptr : std::get_if<NodeTermIntLit*>(&(*term)->var);
+                if (int_lit != nullptr) {
+                    gen.m_output << "    mov rdi, " << (*int_lit)->int_lit.value.value() << "\n";
+                }
+                else {
+                    gen.gen_expr_rax(stmt_exit->expr);
+                    gen.m_output << "    mov rdi, rax\n";
+                }
+                gen.emit_exit();
                 gen.m_output << "    ;; /exit\n";
             }
 
+            void operator()(const NodeStmtPrint* stmt_print) const
+            {
+                gen.m_output << "    ;; print\n";
+                gen.gen_expr_rax(stmt_print->expr);
+                gen.m_output << "    call hydro_print\n";
+                gen.m_output << "    ;; /print\n";
+            }
+
             void operator()(const NodeStmtLet* stmt_let) const
             {
                 gen.m_output << "    ;; let\n";
-                if (std::ranges::find_if(
-                        std::as_const(gen.m_vars),
-                        [&](const Var& var) { return var.name == stmt_let->ident.value.value(); })
-                    != gen.m_vars.cend()) {
+                if (gen.find_var(stmt_let->ident.value.value()) != nullptr) {
                     std::cerr << "Identifier already used: " << stmt_let->ident.value.value() << std::endl;
-                    exit(EXIT_FAILURE);
+                    compile_error();
                 }
-                gen.m_vars.push_back({ .name = stmt_let->ident.value.value(), .stack_loc = gen.m_stack_size });
+                gen.declare_var(stmt_let->ident.value.value());
                 gen.gen_expr(stmt_let->expr);
                 gen.m_output << "    ;; /let\n";
             }
 
             void operator()(const NodeStmtAssign* stmt_assign) const
             {
-                const auto it = std::ranges::find_if(gen.m_vars, [&](const Var& var) {
-                    return var.name == stmt_assign->ident.value.value();
-                });
-                if (it == gen.m_vars.end()) {
+                const Var* it = gen.find_var(stmt_assign->ident.value.value());
+                if (it == nullptr) {
                     std::cerr << "Undeclared identifier: " << stmt_assign->ident.value.value() << std::endl;
-                    exit(EXIT_FAILURE);
+                    compile_error();
                 }
-                gen.gen_expr(stmt_assign->expr);
-                gen.pop("rax");
+                if (it->array_length != 0) {
+                    gen.gen_array_assign(*it, stmt_assign->expr);
+                    return;
+                }
+                gen.gen_expr_rax(stmt_assign->expr);
                 gen.m_output << "    mov [rsp + " << (gen.m_stack_size - it->stack_loc - 1) * 8 << "], rax\n";
             }
 
+            void operator()(const NodeStmtLetArray* let_array) const
+            {
+                gen.m_output << "    ;; let array\n";
+                const std::string& name = let_array->ident.value.value();
+                if (gen.find_var(name) != nullptr) {
+                    std::cerr << "Identifier already used: " << name << std::endl;
+                    compile_error();
+                }
+                const size_t slots = gen.declare_array(name, let_array->length);
+                gen.m_output << "    sub rsp, " << slots * 8 << "\n";
+                const Var& var = *gen.find_var(name);
+                gen.m_output << "    pxor xmm0, xmm0\n";
+                gen.for_each_lane_group(var.array_length, [&](const std::string& at, const size_t byte, const bool wide) {
+                    const std::string addr = "[rsp + " + at + std::to_string(gen.array_offset(var) + byte) + "]";
+                    gen.m_output << (wide ? "    movdqa " + addr + ", xmm0\n" : "    mov QWORD " + addr + ", 0\n");
+                });
+                gen.m_output << "    ;; /let array\n";
+            }
+
+            void operator()(const NodeStmtAssignIndex* assign) const
+            {
+                const Var& var = gen.array_var(assign->ident.value.value());
+                if (const auto index = gen.const_index(var, assign->index)) {
+                    gen.gen_expr_rax(assign->expr);
+                    gen.m_output << "    mov [rsp + " << gen.array_offset(var) + index.value() * 8 << "], rax\n";
+                    return;
+                }
+                gen.gen_expr(assign->index);
+                gen.gen_expr_rax(assign->expr);
+                gen.pop("rbx");
+                gen.m_output << "    mov [rsp + rbx * 8 + " << gen.array_offset(var) << "], rax\n";
+            }
+
             void operator()(const NodeScope* scope) const
             {
                 gen.m_output << "    ;; scope\n";
@@ -211,9 +561,15 @@ public:
 
             void operator()(const NodeStmtIf* stmt_if) const
             {
+                if (gen.m_options.opt_level >= 1 && gen.gen_if_switch(stmt_if)) {
+                    return;
+                }
+                if (!gen.m_profile.empty()) {
+                    gen.gen_if_profiled(stmt_if);
+                    return;
+                }
                 gen.m_output << "    ;; if\n";
-                gen.gen_expr(stmt_if->expr);
-                gen.pop("rax");
+                gen.gen_expr_rax(stmt_if->expr);
                 const std::string label = gen.create_label();
                 gen.m_output << "    test rax, rax\n";
                 gen.m_output << "    jz " << label << "\n";
@@ -223,6 +579,17 @@ public:
                     gen.m_output << "    jmp " << end_label << "\n";
                     gen.m_output << label << ":\n";
                     gen.gen_if_pred(stmt_if->pred.value(), end_label);
+                    if (flatten_if(stmt_if).back().cond != nullptr) {
+                        // Only the path on which every condition failed gets here.
+                        gen.emit_profile_counter(stmt_if);
+                    }
+                    gen.m_output << end_label << ":\n";
+                }
+                else if (gen.m_options.profile_generate.has_value()) {
+                    const std::string end_label = gen.create_label();
+                    gen.m_output << "    jmp " << end_label << "\n";
+                    gen.m_output << label << ":\n";
+                    gen.emit_profile_counter(stmt_if);
                     gen.m_output << end_label << ":\n";
                 }
                 else {
@@ -234,23 +601,1183 @@ public:
 
         StmtVisitor visitor { .gen = *this };
         std::visit(visitor, stmt->var);
+        if (m_scopes.empty() && m_sink != nullptr && m_output.tellp() >= static_cast<std::streamoff>(m_chunk_bytes)) {
+            *m_sink << m_output.view();
+            m_output.str({});
+        }
     }
 
     [[nodiscard]] std::string gen_prog()
     {
+        std::ostringstream out;
+        gen_prog(out);
+        return out.str();
+    }
+
+    // Streams the program to `out`. Code is handed over in chunks at
+    // top-level statement boundaries, so only about `chunk_bytes` of the
+    // main body (plus the cold and read-only sections, which go last) is
+    // ever buffered here.
+    void gen_prog(std::ostream& out, const size_t chunk_bytes = 64 * 1024)
+    {
+        m_sink = &out;
+        m_chunk_bytes = chunk_bytes;
         m_output << "global _start\n_start:\n";
 
-        for (const NodeStmt* stmt : m_prog.stmts) {
-            gen_stmt(stmt);
+        gen_stmts(m_prog.stmts);
+
+        if (m_prog.stmts.empty() || !std::holds_alternative<NodeStmtExit*>(m_prog.stmts.back()->var)) {
+            m_output << "    mov rdi, 0\n";
+            emit_exit();
+        }
+        m_output << m_cold.str();
+        emit_runtime();
+        if (m_rodata.tellp() > 0) {
+            m_output << "section .rodata\n" << m_rodata.str();
+        }
+        out << m_output.view();
+        m_output.str({});
+        m_sink = nullptr;
+    }
+
+    // Piecewise generation for hydro --watch, which reuses the code of
+    // unchanged top-level statements. A program is fragment_prologue(), then
+    // gen_fragment() of each top-level statement in order, then
+    // fragment_epilogue(). Only -O0 output is context-free enough for this.
+    // Fragments refer to the runtime by symbol and may be assembled apart.
+    struct TopLevelMark {
+        size_t vars = 0;
+        size_t stack_size = 0;
+        size_t layout = 0; // Var::layout of the last variable
+
+        bool operator==(const TopLevelMark&) const = default;
+    };
+
+    std::string fragment_prologue()
+    {
+        assert(m_options.opt_level == 0);
+        // A fragment cannot know whether some other one prints, so exit always
+        // goes through hydro_exit and the print runtime is always linked.
+        m_uses_print = true;
+        return "global _start\n_start:\n";
+    }
+
+    // Labels get `label_prefix` so they stay unique across fragments.
+    std::string gen_fragment(const NodeStmt* stmt, const std::string& label_prefix)
+    {
+        m_label_prefix = label_prefix;
+        m_label_count = 0;
+        m_line = 0;
+        gen_stmt(stmt);
+        std::string text = m_output.str();
+        m_output.str({});
+        return text;
+    }
+
+    std::string fragment_epilogue(const bool ends_in_exit)
+    {
+        m_label_prefix.clear();
+        if (!ends_in_exit) {
+            m_output << "    mov rdi, 0\n";
+            emit_exit();
+        }
+        emit_runtime();
+        if (m_rodata.tellp() > 0) {
+            m_output << "section .rodata\n" << m_rodata.str();
+            m_rodata.str({});
+        }
+        std::string text = m_output.str();
+        m_output.str({});
+        return text;
+    }
+
+    // The top-level variables declared so far.
+    [[nodiscard]] TopLevelMark top_level_mark() const
+    {
+        return { .vars = m_vars.size(),
+                 .stack_size = m_stack_size,
+                 .layout = m_vars.empty() ? 0 : m_vars.back().layout };
+    }
+
+    // Forgets the top-level variables declared after `mark`.
+    void rewind_top_level(const TopLevelMark mark)
+    {
+        while (m_vars.size() > mark.vars) {
+            m_var_index.erase(m_vars.back().name);
+            m_vars.pop_back();
+        }
+        m_stack_size = mark.stack_size;
+    }
+
+    // Declares what gen_fragment(stmt) would, without generating any code.
+    // Only valid for a statement whose fragment generated without error.
+    void skip_top_level(const NodeStmt* stmt)
+    {
+        if (const auto stmt_let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            declare_var((*stmt_let)->ident.value.value());
+            m_stack_size++;
+        }
+        else if (const auto let_array = std::get_if<NodeStmtLetArray*>(&stmt->var)) {
+            declare_array((*let_array)->ident.value.value(), (*let_array)->length);
+        }
+    }
+
+private:
+    struct Var {
+        std::string name;
+        size_t stack_loc; // lowest slot; element i of an array is at stack_loc + length - 1 - i
+        size_t array_length = 0; // 0 for a scalar
+        size_t layout = 0; // hash of this and all earlier variables' names and slots
+    };
+
+    struct Scope {
+        size_t vars;
+        size_t stack_size;
+    };
+
+    struct IfBranch {
+        const NodeExpr* cond; // nullptr for the else branch
+        const NodeScope* scope;
+    };
+
+    static std::vector<IfBranch> flatten_if(const NodeStmtIf* stmt_if)
+    {
+        std::vector<IfBranch> branches { { stmt_if->expr, stmt_if->scope } };
+        std::optional<NodeIfPred*> pred = stmt_if->pred;
+        while (pred.has_value()) {
+            if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                branches.push_back({ (*elif)->expr, (*elif)->scope });
+                pred = (*elif)->pred;
+            }
+            else {
+                branches.push_back({ nullptr, std::get<NodeIfPredElse*>(pred.value()->var)->scope });
+                pred = {};
+            }
+        }
+        return branches;
+    }
+
+    // Assigns counter slots in AST pre-order so that an instrumented build and
+    // a later --profile-use build of the same source agree on the numbering.
+    void number_profile_slots(const std::vector<NodeStmt*>& stmts) // NOLINT(*-no-recursion)
+    {
+        m_profile_shape = (m_profile_shape ^ stmts.size()) * 0x100000001b3;
+        for (const NodeStmt* stmt : stmts) {
+            m_profile_shape = (m_profile_shape ^ stmt->var.index()) * 0x100000001b3;
+            if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+                m_profile_slots.emplace(*scope, m_profile_slots.size());
+                number_profile_slots((*scope)->stmts);
+            }
+            else if (const auto stmt_if = std::get_if<NodeStmtIf*>(&stmt->var)) {
+                const std::vector<IfBranch> branches = flatten_if(*stmt_if);
+                for (const auto& [cond, scope] : branches) {
+                    m_profile_slots.emplace(scope, m_profile_slots.size());
+                    number_profile_slots(scope->stmts);
+                }
+                if (branches.back().cond != nullptr) {
+                    m_profile_slots.emplace(*stmt_if, m_profile_slots.size());
+                }
+            }
+        }
+    }
+
+    void emit_profile_counter(const void* node)
+    {
+        if (!m_options.profile_generate.has_value()) {
+            return;
+        }
+        m_output << "    inc QWORD [rel hydro_prof + " << 8 * (m_profile_slots.at(node) + 1) << "]\n";
+    }
+
+    [[nodiscard]] uint64_t profile_count(const void* node) const
+    {
+        return m_profile.at(m_profile_slots.at(node) + 1);
+    }
+
+    // Generates into the out-of-line cold stream, which is placed after the
+    // program's final exit so that it never interrupts the hot path.
+    template <typename F>
+    void gen_cold(F&& f)
+    {
+        std::stringstream cold;
+        std::swap(m_output, cold);
+        const int line = std::exchange(m_line, 0);
+        f();
+        m_line = line;
+        std::swap(m_output, cold);
+        m_cold << cold.str();
+    }
+
+    // Lays out an if/elif/else chain so that its most frequent outcome runs
+    // without a taken branch. Conditions are still tested in source order,
+    // because more than one of them may hold and the first one wins; only the
+    // placement of the bodies changes, so evaluation order is unaffected.
+    void gen_if_profiled(const NodeStmtIf* stmt_if)
+    {
+        const std::vector<IfBranch> branches = flatten_if(stmt_if);
+        const bool has_else = branches.back().cond == nullptr;
+        size_t hot = 0;
+        uint64_t hot_count = 0;
+        for (size_t i = 0; i < branches.size(); i++) {
+            if (profile_count(branches[i].scope) > hot_count) {
+                hot = i;
+                hot_count = profile_count(branches[i].scope);
+            }
+        }
+        if (!has_else && profile_count(stmt_if) > hot_count) {
+            hot = branches.size();
+        }
+
+        m_output << "    ;; if (hot outcome " << hot << ")\n";
+        const std::string end_label = create_label();
+        const auto test_cond = [&](const NodeExpr* cond) {
+            gen_expr_rax(cond);
+            m_output << "    test rax, rax\n";
+        };
+        for (size_t i = 0; i < hot && i < branches.size(); i++) {
+            const std::string cold_label = create_label();
+            test_cond(branches[i].cond);
+            m_output << "    jnz " << cold_label << "\n";
+            gen_cold([&] {
+                m_output << cold_label << ":\n";
+                gen_scope(branches[i].scope);
+                m_output << "    jmp " << end_label << "\n";
+            });
+        }
+        if (hot < branches.size() && branches[hot].cond == nullptr) {
+            gen_scope(branches[hot].scope);
+        }
+        else if (hot + 1 == branches.size()) {
+            test_cond(branches[hot].cond);
+            m_output << "    jz " << end_label << "\n";
+            gen_scope(branches[hot].scope);
         }
+        else if (hot < branches.size()) {
+            const std::string rest_label = create_label();
+            test_cond(branches[hot].cond);
+            m_output << "    jz " << rest_label << "\n";
+            gen_scope(branches[hot].scope);
+            gen_cold([&] {
+                m_output << rest_label << ":\n";
+                for (size_t i = hot + 1; i < branches.size(); i++) {
+                    if (branches[i].cond == nullptr) {
+                        gen_scope(branches[i].scope);
+                        break;
+                    }
+                    const std::string next_label = create_label();
+                    test_cond(branches[i].cond);
+                    m_output << "    jz " << next_label << "\n";
+                    gen_scope(branches[i].scope);
+                    m_output << "    jmp " << end_label << "\n";
+                    m_output << next_label << ":\n";
+                }
+                m_output << "    jmp " << end_label << "\n";
+            });
+        }
+        m_output << end_label << ":\n";
+        m_output << "    ;; /if\n";
+    }
 
+    // An operand an ALU instruction can take directly: an immediate that
+    // sign-extends from 32 bits, or the stack slot of a variable or of a
+    // common subexpression.
+    struct Operand {
+        std::string text;
+        std::optional<uint64_t> literal;
+    };
+
+    static const NodeExpr* strip_parens(const NodeExpr* expr)
+    {
+        while (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            const auto paren = std::get_if<NodeTermParen*>(&(*term)->var);
+            if (paren == nullptr) {
+                break;
+            }
+            expr = (*paren)->expr;
+        }
+        return expr;
+    }
+
+    [[nodiscard]] std::optional<Operand> direct_operand(const NodeExpr* expr) const
+    {
+        expr = strip_parens(expr);
+        if (const auto it = m_cse.find(expr); it != m_cse.end()) {
+            return Operand { "QWORD [rsp + " + std::to_string((m_stack_size - it->second - 1) * 8) + "]", {} };
+        }
+        const auto term = std::get_if<NodeTerm*>(&expr->var);
+        if (term == nullptr) {
+            return {};
+        }
+        if (const auto int_lit = std::get_if<NodeTermIntLit*>(&(*term)->var)) {
+            const uint64_t value = (*int_lit)->value;
+            if (value > INT32_MAX) {
+                return {};
+            }
+            return Operand { std::to_string(value), value };
+        }
+        if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+            const Var& var = array_var((*index)->ident.value.value());
+            if (const auto i = const_index(var, (*index)->index)) {
+                return Operand { "QWORD [rsp + " + std::to_string(array_offset(var) + i.value() * 8) + "]", {} };
+            }
+            return {};
+        }
+        const Var& var = scalar_var(std::get<NodeTermIdent*>((*term)->var)->ident.value.value());
+        return Operand { "QWORD [rsp + " + std::to_string((m_stack_size - var.stack_loc - 1) * 8) + "]", {} };
+    }
+
+    // Accumulator codegen (-O1): evaluates `expr` into rax, folding literal
+    // and variable operands into the instruction that consumes them so that
+    // only a binary expression with two compound sides touches the stack.
+    void gen_acc(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (const auto operand = direct_operand(expr)) {
+            m_output << "    mov rax, " << operand->text << "\n";
+            return;
+        }
+        expr = strip_parens(expr);
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                const Var& var = array_var((*index)->ident.value.value());
+                gen_acc((*index)->index);
+                m_output << "    mov rax, QWORD [rsp + rax * 8 + " << array_offset(var) << "]\n";
+                return;
+            }
+            // An integer literal too wide for an immediate operand.
+            m_output << "    mov rax, " << std::get<NodeTermIntLit*>((*term)->var)->int_lit.value.value() << "\n";
+            return;
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        if (m_options.opt_level >= 2 && gen_superopt(bin)) {
+            return;
+        }
+        const auto [lhs_side, rhs_side] = operands(bin);
+        const NodeExpr* lhs = lhs_side;
+        const NodeExpr* rhs = rhs_side;
+        const bool commutative = !std::holds_alternative<NodeBinExprSub*>(bin->var)
+            && !std::holds_alternative<NodeBinExprDiv*>(bin->var);
+        std::optional<Operand> rhs_operand = direct_operand(rhs);
+        const std::optional<Operand> lhs_operand = direct_operand(lhs);
+        if (!rhs_operand.has_value() && lhs_operand.has_value() && commutative) {
+            std::swap(lhs, rhs);
+            rhs_operand = lhs_operand;
+        }
+        if (rhs_operand.has_value()) {
+            gen_acc(lhs);
+            emit_alu(bin, rhs_operand.value());
+        }
+        else if (lhs_operand.has_value()) {
+            gen_acc(rhs);
+            m_output << "    mov rbx, rax\n";
+            m_output << "    mov rax, " << lhs_operand->text << "\n";
+            emit_alu(bin, { "rbx", {} });
+        }
+        else {
+            gen_acc(rhs);
+            push("rax");
+            gen_acc(lhs);
+            pop("rbx");
+            emit_alu(bin, { "rbx", {} });
+        }
+    }
+
+    static std::pair<const NodeExpr*, const NodeExpr*> operands(const NodeBinExpr* bin)
+    {
+        return std::visit([](const auto* op) { return std::pair<const NodeExpr*, const NodeExpr*> { op->lhs, op->rhs }; },
+                          bin->var);
+    }
+
+    // The value of `expr` if it is an immediate literal.
+    [[nodiscard]] std::optional<int64_t> literal(const NodeExpr* expr) const
+    {
+        const std::optional<Operand> operand = direct_operand(expr);
+        if (!operand.has_value() || !operand->literal.has_value()) {
+            return {};
+        }
+        return static_cast<int64_t>(operand->literal.value());
+    }
+
+    // `expr` as x * k with a literal k, or else x * 1. A product that is a
+    // common subexpression is left whole.
+    [[nodiscard]] std::pair<const NodeExpr*, int64_t> scaled(const NodeExpr* expr) const
+    {
+        const NodeExpr* stripped = strip_parens(expr);
+        const auto bin = std::get_if<NodeBinExpr*>(&stripped->var);
+        if (bin == nullptr || !std::holds_alternative<NodeBinExprMulti*>((*bin)->var) || m_cse.contains(stripped)) {
+            return { expr, 1 };
+        }
+        const auto [lhs, rhs] = operands(*bin);
+        if (const auto k = literal(rhs)) {
+            return { lhs, k.value() };
+        }
+        if (const auto k = literal(lhs)) {
+            return { rhs, k.value() };
+        }
+        return { expr, 1 };
+    }
+
+    // -O2: lowers (x +- c) * d and x * k1 +- y * k2 with the superoptimizer's
+    // sequence for those constants, if superopt_table.hpp has one. Returns
+    // false, generating nothing, otherwise.
+    bool gen_superopt(const NodeBinExpr* bin) // NOLINT(*-no-recursion)
+    {
+        const auto [lhs, rhs] = operands(bin);
+        if (std::holds_alternative<NodeBinExprMulti*>(bin->var)) {
+            for (const auto& [factor, inner] : { std::pair { rhs, lhs }, std::pair { lhs, rhs } }) {
+                const std::optional<int64_t> d = literal(factor);
+                const NodeExpr* sum = strip_parens(inner);
+                const auto sum_bin = std::get_if<NodeBinExpr*>(&sum->var);
+                if (!d.has_value() || sum_bin == nullptr || m_cse.contains(sum)) {
+                    continue;
+                }
+                const auto [x, c] = operands(*sum_bin);
+                // x - c, x + c or c + x
+                const NodeExpr* var = x;
+                std::optional<int64_t> offset;
+                if (std::holds_alternative<NodeBinExprSub*>((*sum_bin)->var)) {
+                    // Negated modulo 2^64 like the sub it replaces; -INT64_MIN would overflow.
+                    if (const auto k = literal(c)) {
+                        offset = static_cast<int64_t>(0 - static_cast<uint64_t>(k.value()));
+                    }
+                }
+                else if (std::holds_alternative<NodeBinExprAdd*>((*sum_bin)->var)) {
+                    offset = literal(c);
+                    if (!offset.has_value()) {
+                        var = c;
+                        offset = literal(x);
+                    }
+                }
+                if (!offset.has_value() || literal(var).has_value()) {
+                    continue;
+                }
+                if (const SuperoptEntry* entry = superopt_lookup(SuperoptShape::offset_mul, offset.value(), d.value())) {
+                    gen_acc(var);
+                    m_output << entry->code;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const bool sub = std::holds_alternative<NodeBinExprSub*>(bin->var);
+        if (!sub && !std::holds_alternative<NodeBinExprAdd*>(bin->var)) {
+            return false;
+        }
+        auto [x, k1] = scaled(lhs);
+        auto [y, k2] = scaled(rhs);
+        k2 = sub ? static_cast<int64_t>(0 - static_cast<uint64_t>(k2)) : k2; // wraps like the sub
+        const SuperoptEntry* entry = superopt_lookup(SuperoptShape::lin_comb, k1, k2);
+        if (entry == nullptr && !sub) {
+            std::swap(x, y);
+            std::swap(k1, k2);
+            entry = superopt_lookup(SuperoptShape::lin_comb, k1, k2);
+        }
+        if (entry == nullptr || literal(x).has_value() || literal(y).has_value()) {
+            return false;
+        }
+        if (const auto y_operand = direct_operand(y)) {
+            gen_acc(x);
+            m_output << "    mov rbx, " << y_operand->text << "\n";
+        }
+        else if (const auto x_operand = direct_operand(x)) {
+            gen_acc(y);
+            m_output << "    mov rbx, rax\n";
+            m_output << "    mov rax, " << x_operand->text << "\n";
+        }
+        else {
+            gen_acc(y);
+            push("rax");
+            gen_acc(x);
+            pop("rbx");
+        }
+        m_output << entry->code;
+        return true;
+    }
+
+    // rax = rax <op> operand
+    void emit_alu(const NodeBinExpr* bin, const Operand& operand)
+    {
+        const std::optional<uint64_t> k = operand.literal;
+        if (std::holds_alternative<NodeBinExprAdd*>(bin->var)) {
+            if (k.has_value()) {
+                m_output << "    lea rax, [rax + " << k.value() << "]\n";
+            }
+            else {
+                m_output << "    add rax, " << operand.text << "\n";
+            }
+        }
+        else if (std::holds_alternative<NodeBinExprSub*>(bin->var)) {
+            m_output << "    sub rax, " << operand.text << "\n";
+        }
+        else if (std::holds_alternative<NodeBinExprMulti*>(bin->var)) {
+            const SuperoptEntry* entry = m_options.opt_level >= 2 && k.has_value()
+                ? superopt_lookup(SuperoptShape::mul, static_cast<int64_t>(k.value()), 0)
+                : nullptr;
+            if (entry != nullptr) {
+                m_output << entry->code;
+            }
+            else if (k == 2 || k == 3 || k == 5 || k == 9) {
+                m_output << "    lea rax, [rax + rax * " << k.value() - 1 << "]\n";
+            }
+            else if (k == 4 || k == 8) {
+                m_output << "    lea rax, [rax * " << k.value() << "]\n";
+            }
+            else if (k.has_value()) {
+                m_output << "    imul rax, rax, " << k.value() << "\n";
+            }
+            else {
+                m_output << "    imul rax, " << operand.text << "\n";
+            }
+        }
+        else if (std::holds_alternative<NodeBinExprDiv*>(bin->var)) {
+            if (k.has_value()) {
+                m_output << "    mov rbx, " << k.value() << "\n";
+            }
+            m_output << "    xor rdx, rdx\n";
+            m_output << "    div " << (k.has_value() ? "rbx" : operand.text) << "\n";
+        }
+        else {
+            m_output << "    cmp rax, " << operand.text << "\n";
+            m_output << "    sete al\n";
+            m_output << "    movzx rax, al\n";
+        }
+    }
+
+    // The value of a literal index into `var`, checked against its length.
+    // Indices computed at run time are not checked.
+    [[nodiscard]] static std::optional<size_t> const_index(const Var& var, const NodeExpr* index)
+    {
+        const auto term = std::get_if<NodeTerm*>(&strip_parens(index)->var);
+        const auto int_lit = term == nullptr ? nullptr : std::get_if<NodeTermIntLit*>(&(*term)->var);
+        if (int_lit == nullptr) {
+            return {};
+        }
+        const uint64_t value = (*int_lit)->value;
+        if (value >= var.array_length) {
+            std::cerr << "Array index out of bounds: " << var.name << "[" << value << "]" << std::endl;
+            compile_error();
+        }
+        return value;
+    }
+
+    // Calls step(at, byte, wide) for each 16-byte group of an array of
+    // `length` elements, then (wide = false) for the last element of an odd
+    // length. The address of a group is [rsp + <at><offset + byte>]. Short
+    // arrays are unrolled; longer ones get a loop that counts rcx up by 16.
+    template <typename F>
+    void for_each_lane_group(const size_t length, F&& step)
+    {
+        constexpr size_t max_unrolled = 4;
+        const size_t groups = length / 2;
+        if (groups <= max_unrolled) {
+            for (size_t group = 0; group < groups; group++) {
+                step("", group * 16, true);
+            }
+        }
+        else {
+            const std::string loop_label = create_label();
+            m_output << "    xor ecx, ecx\n";
+            m_output << loop_label << ":\n";
+            step("rcx + ", 0, true);
+            m_output << "    add rcx, 16\n";
+            m_output << "    cmp rcx, " << groups * 16 << "\n";
+            m_output << "    jne " << loop_label << "\n";
+        }
+        if (length % 2 != 0) {
+            step("", groups * 16, false);
+        }
+    }
+
+    // Checks that `expr` is + and - over arrays of `length` elements.
+    void check_array_expr(const NodeExpr* expr, const size_t length) const // NOLINT(*-no-recursion)
+    {
+        expr = strip_parens(expr);
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var);
+            if (ident == nullptr) {
+                std::cerr << "Only arrays can be combined into an array" << std::endl;
+                compile_error();
+            }
+            const Var& var = array_var((*ident)->ident.value.value());
+            if (var.array_length != length) {
+                std::cerr << "Array length mismatch: " << var.name << " has " << var.array_length << " elements, "
+                          << length << " expected" << std::endl;
+                compile_error();
+            }
+            return;
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        const auto add = std::get_if<NodeBinExprAdd*>(&bin->var);
+        const auto sub = std::get_if<NodeBinExprSub*>(&bin->var);
+        if (add == nullptr && sub == nullptr) {
+            std::cerr << "Only + and - apply to whole arrays" << std::endl;
+            compile_error();
+        }
+        check_array_expr(add != nullptr ? (*add)->lhs : (*sub)->lhs, length);
+        check_array_expr(add != nullptr ? (*add)->rhs : (*sub)->rhs, length);
+    }
+
+    // Evaluates one group of an array expression into xmm<reg>: two lanes
+    // with paddq/psubq when `wide`, otherwise the low lane only. An array
+    // operand on the right of a wide operation is used straight from memory.
+    void gen_array_lanes( // NOLINT(*-no-recursion)
+        const NodeExpr* expr,
+        const int reg,
+        const std::string& at,
+        const size_t byte,
+        const bool wide)
+    {
+        constexpr int xmm_regs = 16;
+        if (reg >= xmm_regs) {
+            std::cerr << "Array expression too deeply nested" << std::endl;
+            compile_error();
+        }
+        const auto addr = [&](const NodeExpr* leaf) {
+            const NodeTerm* term = std::get<NodeTerm*>(leaf->var);
+            const Var& var = *find_var(std::get<NodeTermIdent*>(term->var)->ident.value.value());
+            return "[rsp + " + at + std::to_string(array_offset(var) + byte) + "]";
+        };
+        expr = strip_parens(expr);
+        if (std::holds_alternative<NodeTerm*>(expr->var)) {
+            m_output << (wide ? "    movdqa xmm" : "    movq xmm") << reg << ", " << (wide ? "" : "QWORD ") << addr(expr)
+                     << "\n";
+            return;
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        const std::string op = std::holds_alternative<NodeBinExprAdd*>(bin->var) ? "paddq" : "psubq";
+        const NodeExpr* lhs = nullptr;
+        const NodeExpr* rhs = nullptr;
+        std::visit(
+            [&](const auto* bin_op) {
+                lhs = bin_op->lhs;
+                rhs = strip_parens(bin_op->rhs);
+            },
+            bin->var);
+        gen_array_lanes(lhs, reg, at, byte, wide);
+        if (wide && std::holds_alternative<NodeTerm*>(rhs->var)) {
+            m_output << "    " << op << " xmm" << reg << ", " << addr(rhs) << "\n";
+            return;
+        }
+        gen_array_lanes(rhs, reg + 1, at, byte, wide);
+        m_output << "    " << op << " xmm" << reg << ", xmm" << reg + 1 << "\n";
+    }
+
+    // `array = expr`, element-wise. Arrays are 16-byte aligned (see
+    // NodeStmtLetArray), so two elements are loaded, combined and stored per
+    // SSE2 instruction; the whole expression is fused into one pass.
+    void gen_array_assign(const Var& dst, const NodeExpr* expr)
+    {
+        check_array_expr(expr, dst.array_length);
+        m_output << "    ;; array " << dst.name << "\n";
+        for_each_lane_group(dst.array_length, [&](const std::string& at, const size_t byte, const bool wide) {
+            gen_array_lanes(expr, 0, at, byte, wide);
+            const std::string addr = "[rsp + " + at + std::to_string(array_offset(dst) + byte) + "]";
+            m_output << (wide ? "    movdqa " + addr : "    movq QWORD " + addr) << ", xmm0\n";
+        });
+        m_output << "    ;; /array\n";
+    }
+
+    // Names the variable a statement stores to, if any.
+    static std::optional<std::string_view> stored_var(const NodeStmt* stmt)
+    {
+        if (const auto assign = std::get_if<NodeStmtAssign*>(&stmt->var)) {
+            return (*assign)->ident.value.value();
+        }
+        if (const auto let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            return (*let)->ident.value.value();
+        }
+        if (const auto assign = std::get_if<NodeStmtAssignIndex*>(&stmt->var)) {
+            return (*assign)->ident.value.value();
+        }
+        return {};
+    }
+
+    // Identifiers read by `expr`, memoized per (shared) node.
+    const std::vector<std::string_view>& cse_deps(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (const auto it = m_cse_deps.find(expr); it != m_cse_deps.end()) {
+            return it->second;
+        }
+        std::vector<std::string_view> deps;
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                deps.emplace_back((*ident)->ident.value.value());
+            }
+            else if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+                deps = cse_deps((*paren)->expr);
+            }
+            else if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                deps = cse_deps((*index)->index);
+                if (std::ranges::find(deps, (*index)->ident.value.value()) == deps.end()) {
+                    deps.emplace_back((*index)->ident.value.value());
+                }
+            }
+        }
+        else {
+            std::visit(
+                [&](const auto* op) {
+                    deps = cse_deps(op->lhs);
+                    for (const std::string_view dep : cse_deps(op->rhs)) {
+                        if (std::ranges::find(deps, dep) == deps.end()) {
+                            deps.push_back(dep);
+                        }
+                    }
+                },
+                std::get<NodeBinExpr*>(expr->var)->var);
+        }
+        return m_cse_deps.emplace(expr, std::move(deps)).first->second;
+    }
+
+    // For each statement of a basic block, the binary expressions that should
+    // be evaluated into a hidden local before it because a later occurrence,
+    // with no intervening store to one of their operands, can reuse the value.
+    // Listed children first so that a materialized node can use its children.
+    std::vector<std::vector<const NodeExpr*>> find_common_subexprs(const std::span<NodeStmt* const> block)
+    {
+        struct Occurrence {
+            const NodeExpr* expr;
+            bool reused;
+        };
+        struct Scan {
+            Generator& gen;
+            std::vector<Occurrence> occurrences {};
+            std::vector<std::vector<size_t>> first_seen {};
+            std::unordered_map<const NodeExpr*, size_t> live {};
+            std::unordered_map<std::string_view, std::vector<const NodeExpr*>> users {};
+
+            void visit(const NodeExpr* expr, const size_t stmt) // NOLINT(*-no-recursion)
+            {
+                if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+                    if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+                        visit((*paren)->expr, stmt);
+                    }
+                    else if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                        visit((*index)->index, stmt);
+                    }
+                    return;
+                }
+                if (const auto it = live.find(expr); it != live.end()) {
+                    occurrences[it->second].reused = true;
+                    return;
+                }
+                std::visit(
+                    [&](const auto* op) {
+                        visit(op->rhs, stmt);
+                        visit(op->lhs, stmt);
+                    },
+                    std::get<NodeBinExpr*>(expr->var)->var);
+                live.emplace(expr, occurrences.size());
+                first_seen[stmt].push_back(occurrences.size());
+                occurrences.push_back({ expr, false });
+                for (const std::string_view dep : gen.cse_deps(expr)) {
+                    users[dep].push_back(expr);
+                }
+            }
+        } scan { .gen = *this };
+        scan.first_seen.resize(block.size());
+        // Whole-array assignments are vector code, not scalar subexpressions.
+        std::unordered_set<std::string_view> block_arrays;
+        const auto is_array = [&](const std::string& name) {
+            const Var* var = find_var(name);
+            return block_arrays.contains(name) || (var != nullptr && var->array_length != 0);
+        };
+        for (size_t i = 0; i < block.size(); i++) {
+            if (const auto exit_ = std::get_if<NodeStmtExit*>(&block[i]->var)) {
+                scan.visit((*exit_)->expr, i);
+            }
+            else if (const auto let = std::get_if<NodeStmtLet*>(&block[i]->var)) {
+                scan.visit((*let)->expr, i);
+            }
+            else if (const auto stmt_print = std::get_if<NodeStmtPrint*>(&block[i]->var)) {
+                scan.visit((*stmt_print)->expr, i);
+            }
+            else if (const auto let_array = std::get_if<NodeStmtLetArray*>(&block[i]->var)) {
+                block_arrays.insert((*let_array)->ident.value.value());
+            }
+            else if (const auto assign_index = std::get_if<NodeStmtAssignIndex*>(&block[i]->var)) {
+                scan.visit((*assign_index)->expr, i);
+                scan.visit((*assign_index)->index, i);
+            }
+            else if (const auto assign = std::get<NodeStmtAssign*>(block[i]->var); !is_array(assign->ident.value.value())) {
+                scan.visit(assign->expr, i);
+            }
+            if (const auto stored = stored_var(block[i])) {
+                for (const NodeExpr* user : scan.users[stored.value()]) {
+                    scan.live.erase(user);
+                }
+                scan.users.erase(stored.value());
+            }
+        }
+
+        std::vector<std::vector<const NodeExpr*>> materialize(block.size());
+        for (size_t i = 0; i < block.size(); i++) {
+            for (const size_t occurrence : scan.first_seen[i]) {
+                if (scan.occurrences[occurrence].reused) {
+                    materialize[i].push_back(scan.occurrences[occurrence].expr);
+                }
+            }
+        }
+        return materialize;
+    }
+
+    // Generates a run of straight-line statements, keeping each common
+    // subexpression in a hidden local from its first use until one of its
+    // operands is stored to. Hidden locals are named so that no source
+    // identifier can refer to them, and are popped with the enclosing scope.
+    void gen_block(const std::span<NodeStmt* const> block)
+    {
+        const std::vector<std::vector<const NodeExpr*>> materialize = find_common_subexprs(block);
+        std::unordered_map<std::string_view, std::vector<const NodeExpr*>> users;
+        for (size_t i = 0; i < block.size(); i++) {
+            if (!materialize[i].empty()) {
+                emit_line(block[i]->line);
+            }
+            for (const NodeExpr* expr : materialize[i]) {
+                m_output << "    ;; cse\n";
+                const size_t stack_loc = m_stack_size;
+                declare_var("$cse" + std::to_string(m_cse_count++));
+                gen_expr(expr);
+                m_cse.emplace(expr, stack_loc);
+                for (const std::string_view dep : cse_deps(expr)) {
+                    users[dep].push_back(expr);
+                }
+            }
+            gen_stmt(block[i]);
+            if (const auto stored = stored_var(block[i])) {
+                for (const NodeExpr* user : users[stored.value()]) {
+                    m_cse.erase(user);
+                }
+                users.erase(stored.value());
+            }
+        }
+        m_cse.clear();
+    }
+
+    // Returns the variable and constant of a `x == k` or `k == x` condition.
+    static std::optional<std::pair<std::string, int64_t>> match_eq_const(const NodeExpr* expr)
+    {
+        const auto term_of = [&](const NodeExpr* e) -> const NodeTerm* {
+            const auto term = std::get_if<NodeTerm*>(&strip_parens(e)->var);
+            return term == nullptr ? nullptr : *term;
+        };
+        const auto bin = std::get_if<NodeBinExpr*>(&strip_parens(expr)->var);
+        if (bin == nullptr) {
+            return {};
+        }
+        const auto eq = std::get_if<NodeBinExprEq*>(&(*bin)->var);
+        if (eq == nullptr) {
+            return {};
+        }
+        const NodeTerm* lhs = term_of((*eq)->lhs);
+        const NodeTerm* rhs = term_of((*eq)->rhs);
+        if (lhs == nullptr || rhs == nullptr) {
+            return {};
+        }
+        if (std::holds_alternative<NodeTermIntLit*>(lhs->var)) {
+            std::swap(lhs, rhs);
+        }
+        const auto ident = std::get_if<NodeTermIdent*>(&lhs->var);
+        const auto int_lit = std::get_if<NodeTermIntLit*>(&rhs->var);
+        if (ident == nullptr || int_lit == nullptr) {
+            return {};
+        }
+        const auto value = static_cast<int64_t>((*int_lit)->value);
+        return std::make_pair((*ident)->ident.value.value(), value);
+    }
+
+    // Lowers an if/elif chain whose conditions all compare the same variable
+    // against constants: dense constant sets dispatch through a bounds-checked
+    // jump table in .rodata, sparse ones through a binary-search decision tree.
+    // Returns false, generating nothing, if the chain does not qualify.
+    bool gen_if_switch(const NodeStmtIf* stmt_if)
+    {
+        constexpr size_t min_cases = 4;
+        constexpr uint64_t max_table_entries = 4096;
+
+        const std::vector<IfBranch> branches = flatten_if(stmt_if);
+        std::optional<std::string> var_name;
+        std::vector<std::pair<int64_t, size_t>> cases; // constant -> branch index
+        for (size_t i = 0; i < branches.size(); i++) {
+            if (branches[i].cond == nullptr) {
+                break;
+            }
+            const auto match = match_eq_const(branches[i].cond);
+            if (!match.has_value() || (var_name.has_value() && var_name.value() != match->first)) {
+                return false;
+            }
+            var_name = match->first;
+            // A repeated constant can never reach its later branch.
+            if (std::ranges::find(cases, match->second, &std::pair<int64_t, size_t>::first) == cases.end()) {
+                cases.emplace_back(match->second, i);
+            }
+        }
+        if (cases.size() < min_cases) {
+            return false;
+        }
+        const Var* var = &scalar_var(var_name.value());
+        std::ranges::sort(cases);
+
+        const std::string end_label = create_label();
+        const std::string default_label = create_label();
+        std::vector<std::string> case_labels;
+        for (size_t i = 0; i < branches.size(); i++) {
+            case_labels.push_back(create_label());
+        }
+
+        m_output << "    ;; switch " << var_name.value() << "\n";
+        m_output << "    mov rax, QWORD [rsp + " << (m_stack_size - var->stack_loc - 1) * 8 << "]\n";
+        const auto span = static_cast<uint64_t>(cases.back().first) - static_cast<uint64_t>(cases.front().first);
+        if (span < max_table_entries && span + 1 <= 2 * cases.size()) {
+            const std::string table_label = create_label();
+            m_output << "    mov rbx, " << cases.front().first << "\n";
+            m_output << "    sub rax, rbx\n";
+            m_output << "    cmp rax, " << span << "\n";
+            m_output << "    ja " << default_label << "\n";
+            m_output << "    lea rbx, [rel " << table_label << "]\n";
+            m_output << "    jmp [rbx + rax * 8]\n";
+            m_rodata << table_label << ":\n";
+            auto it = cases.begin();
+            for (uint64_t offset = 0; offset <= span; offset++) {
+                const auto value = static_cast<int64_t>(static_cast<uint64_t>(cases.front().first) + offset);
+                if (it != cases.end() && it->first == value) {
+                    m_rodata << "    dq " << case_labels[(it++)->second] << "\n";
+                }
+                else {
+                    m_rodata << "    dq " << default_label << "\n";
+                }
+            }
+        }
+        else {
+            m_output << "    mov rbx, rax\n";
+            gen_decision_tree(cases, 0, cases.size(), case_labels, default_label);
+        }
+
+        for (size_t i = 0; i < branches.size(); i++) {
+            if (branches[i].cond == nullptr) {
+                break;
+            }
+            m_output << case_labels[i] << ":\n";
+            gen_scope(branches[i].scope);
+            m_output << "    jmp " << end_label << "\n";
+        }
+        m_output << default_label << ":\n";
+        if (branches.back().cond == nullptr) {
+            gen_scope(branches.back().scope);
+        }
+        else {
+            emit_profile_counter(stmt_if);
+        }
+        m_output << end_label << ":\n";
+        m_output << "    ;; /switch\n";
+        return true;
+    }
+
+    // Binary search over cases[lo, hi) for the value in rbx.
+    void gen_decision_tree( // NOLINT(*-no-recursion)
+        const std::vector<std::pair<int64_t, size_t>>& cases,
+        const size_t lo,
+        const size_t hi,
+        const std::vector<std::string>& case_labels,
+        const std::string& default_label)
+    {
+        if (hi - lo <= 3) {
+            for (size_t i = lo; i < hi; i++) {
+                m_output << "    mov rax, " << cases[i].first << "\n";
+                m_output << "    cmp rbx, rax\n";
+                m_output << "    je " << case_labels[cases[i].second] << "\n";
+            }
+            m_output << "    jmp " << default_label << "\n";
+            return;
+        }
+        const size_t mid = lo + (hi - lo) / 2;
+        const std::string lower_label = create_label();
+        m_output << "    mov rax, " << cases[mid].first << "\n";
+        m_output << "    cmp rbx, rax\n";
+        m_output << "    je " << case_labels[cases[mid].second] << "\n";
+        m_output << "    jl " << lower_label << "\n";
+        gen_decision_tree(cases, mid + 1, hi, case_labels, default_label);
+        m_output << lower_label << ":\n";
+        gen_decision_tree(cases, lo, mid, case_labels, default_label);
+    }
+
+    static bool uses_print(const std::vector<NodeStmt*>& stmts) // NOLINT(*-no-recursion)
+    {
+        for (const NodeStmt* stmt : stmts) {
+            if (std::holds_alternative<NodeStmtPrint*>(stmt->var)) {
+                return true;
+            }
+            if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+                if (uses_print((*scope)->stmts)) {
+                    return true;
+                }
+            }
+            else if (const auto stmt_if = std::get_if<NodeStmtIf*>(&stmt->var)) {
+                for (const auto& [cond, scope] : flatten_if(*stmt_if)) {
+                    if (uses_print(scope->stmts)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool needs_exit_hook() const
+    {
+        return m_options.profile_generate.has_value() || m_uses_print;
+    }
+
+    // Terminates the process with the exit code held in rdi.
+    void emit_exit()
+    {
+        if (needs_exit_hook()) {
+            m_output << "    jmp hydro_exit\n";
+            return;
+        }
         m_output << "    mov rax, 60\n";
-        m_output << "    mov rdi, 0\n";
         m_output << "    syscall\n";
-        return m_output.str();
     }
 
-private:
+    void emit_runtime()
+    {
+        if (!needs_exit_hook()) {
+            return;
+        }
+        m_output << "hydro_exit:\n";
+        m_output << "    push rdi\n";
+        if (m_uses_print) {
+            m_output << "    call hydro_flush\n";
+        }
+        if (m_options.profile_generate.has_value()) {
+            m_output << "    mov rax, 2\n"; // open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+            m_output << "    lea rdi, [rel hydro_prof_path]\n";
+            m_output << "    mov rsi, 577\n";
+            m_output << "    mov rdx, 420\n";
+            m_output << "    syscall\n";
+            m_output << "    test rax, rax\n";
+            m_output << "    js hydro_exit_prof_done\n";
+            m_output << "    mov rdi, rax\n";
+            m_output << "    mov rax, 1\n"; // write(fd, hydro_prof, size)
+            m_output << "    lea rsi, [rel hydro_prof]\n";
+            m_output << "    mov rdx, " << 8 * (m_profile_slots.size() + 1) << "\n";
+            m_output << "    syscall\n";
+            m_output << "    mov rax, 3\n"; // close(fd)
+            m_output << "    syscall\n";
+            m_output << "hydro_exit_prof_done:\n";
+        }
+        m_output << "    pop rdi\n";
+        m_output << "    mov rax, 60\n";
+        m_output << "    syscall\n";
+        if (m_uses_print) {
+            emit_print_runtime();
+        }
+        if (m_options.profile_generate.has_value()) {
+            m_output << "section .data\n";
+            m_output << "hydro_prof:\n";
+            m_output << "    dq " << m_profile_shape << "\n";
+            m_output << "    times " << m_profile_slots.size() << " dq 0\n";
+            m_rodata << "hydro_prof_path:\n";
+            // As byte values: a quote or newline in the path would end a string.
+            m_rodata << "    db ";
+            for (const char c : m_options.profile_generate.value()) {
+                m_rodata << static_cast<int>(static_cast<unsigned char>(c)) << ", ";
+            }
+            m_rodata << "0\n";
+        }
+    }
+
+    // print(): decimal formatting into an in-binary buffer that is flushed
+    // with one write(2) when it fills up and at exit.
+    //
+    // hydro_print renders the unsigned value in rax two digits at a time:
+    // n / 100 comes from a multiply by the 2^66/100 reciprocal (no div), the
+    // pair is looked up in a 200-byte table, and the leading digit of an odd
+    // length is dropped with a flag-derived pointer adjustment instead of a
+    // branch. The digits are built right to left in a scratch area and
+    // copied into the buffer with three unconditional 8-byte moves.
+    // Clobbers rax, rcx, rdx, rsi, rdi, r8, r9 and r11.
+    void emit_print_runtime()
+    {
+        constexpr int buffer_bytes = 4096;
+        constexpr int max_text = 24; // 20 digits and a newline, rounded up for the copy
+        m_output << "hydro_print:\n";
+        m_output << "    mov rcx, [rel hydro_out_len]\n";
+        m_output << "    cmp rcx, " << buffer_bytes - max_text << "\n";
+        m_output << "    jbe hydro_print_room\n";
+        m_output << "    push rax\n";
+        m_output << "    call hydro_flush\n";
+        m_output << "    pop rax\n";
+        m_output << "    xor rcx, rcx\n";
+        m_output << "hydro_print_room:\n";
+        m_output << "    lea rsi, [rel hydro_print_tmp + " << max_text - 1 << "]\n";
+        m_output << "    mov BYTE [rsi], 10\n";
+        m_output << "    lea r9, [rel hydro_digit_pairs]\n";
+        m_output << "hydro_print_pair:\n";
+        m_output << "    cmp rax, 100\n";
+        m_output << "    jb hydro_print_last\n";
+        m_output << "    mov r8, rax\n";
+        m_output << "    shr rax, 2\n";
+        m_output << "    mov rdx, 0x28F5C28F5C28F5C3\n";
+        m_output << "    mul rdx\n";
+        m_output << "    shr rdx, 2\n"; // n / 100
+        m_output << "    imul rax, rdx, 100\n";
+        m_output << "    sub r8, rax\n"; // n % 100
+        m_output << "    movzx eax, WORD [r9 + r8 * 2]\n";
+        m_output << "    sub rsi, 2\n";
+        m_output << "    mov [rsi], ax\n";
+        m_output << "    mov rax, rdx\n";
+        m_output << "    jmp hydro_print_pair\n";
+        m_output << "hydro_print_last:\n";
+        m_output << "    movzx edx, WORD [r9 + rax * 2]\n";
+        m_output << "    sub rsi, 2\n";
+        m_output << "    mov [rsi], dx\n";
+        m_output << "    cmp rax, 10\n";
+        m_output << "    adc rsi, 0\n"; // skip the leading zero of a single digit
+        m_output << "    lea rdi, [rel hydro_out_buf]\n";
+        m_output << "    add rdi, rcx\n";
+        m_output << "    lea rdx, [rel hydro_print_tmp + " << max_text << "]\n";
+        m_output << "    sub rdx, rsi\n";
+        m_output << "    add rcx, rdx\n";
+        m_output << "    mov [rel hydro_out_len], rcx\n";
+        for (int offset = 0; offset < max_text; offset += 8) {
+            m_output << "    mov rax, [rsi + " << offset << "]\n";
+            m_output << "    mov [rdi + " << offset << "], rax\n";
+        }
+        m_output << "    ret\n";
+
+        m_output << "hydro_flush:\n";
+        m_output << "    lea rsi, [rel hydro_out_buf]\n";
+        m_output << "    mov rdx, [rel hydro_out_len]\n";
+        m_output << "hydro_flush_loop:\n";
+        m_output << "    test rdx, rdx\n";
+        m_output << "    jz hydro_flush_done\n";
+        m_output << "    mov rax, 1\n"; // write(1, buf, len)
+        m_output << "    mov rdi, 1\n";
+        m_output << "    syscall\n";
+        m_output << "    test rax, rax\n";
+        m_output << "    jle hydro_flush_done\n";
+        m_output << "    add rsi, rax\n";
+        m_output << "    sub rdx, rax\n";
+        m_output << "    jmp hydro_flush_loop\n";
+        m_output << "hydro_flush_done:\n";
+        m_output << "    mov QWORD [rel hydro_out_len], 0\n";
+        m_output << "    ret\n";
+
+        m_output << "section .bss\n";
+        m_output << "hydro_out_buf:\n";
+        m_output << "    resb " << buffer_bytes << "\n";
+        m_output << "hydro_out_len:\n";
+        m_output << "    resq 1\n";
+        m_output << "hydro_print_tmp:\n";
+        m_output << "    resb " << 2 * max_text << "\n";
+        m_rodata << "hydro_digit_pairs:\n";
+        m_rodata << "    db \"";
+        for (int i = 0; i < 100; i++) {
+            m_rodata << static_cast<char>('0' + i / 10) << static_cast<char>('0' + i % 10);
+        }
+        m_rodata << "\"\n";
+    }
+
     void push(const std::string& reg)
     {
         m_output << "    push " << reg << "\n";
@@ -263,19 +1790,30 @@ private:
         m_stack_size--;
     }
 
+    void emit_line(const int line)
+    {
+        if (!m_options.debug_source.has_value() || line == m_line) {
+            return;
+        }
+        m_output << "%line " << line << "+0 " << m_options.debug_source.value() << "\n";
+        m_line = line;
+    }
+
     void begin_scope()
     {
-        m_scopes.push_back(m_vars.size());
+        m_scopes.push_back({ .vars = m_vars.size(), .stack_size = m_stack_size });
     }
 
     void end_scope()
     {
-        const size_t pop_count = m_vars.size() - m_scopes.back();
+        // Arrays and their alignment padding take more than one slot per variable.
+        const size_t pop_count = m_stack_size - m_scopes.back().stack_size;
         if (pop_count != 0) {
             m_output << "    add rsp, " << pop_count * 8 << "\n";
         }
         m_stack_size -= pop_count;
-        for (size_t i = 0; i < pop_count; i++) {
+        while (m_vars.size() > m_scopes.back().vars) {
+            m_var_index.erase(m_vars.back().name);
             m_vars.pop_back();
         }
         m_scopes.pop_back();
@@ -284,19 +1822,95 @@ private:
     std::string create_label()
     {
         std::stringstream ss;
-        ss << "label" << m_label_count++;
+        ss << "label" << m_label_prefix << m_label_count++;
         return ss.str();
     }
 
-    struct Var {
-        std::string name;
-        size_t stack_loc;
-    };
+    [[nodiscard]] const Var* find_var(const std::string& name) const
+    {
+        const auto it = m_var_index.find(name);
+        if (it == m_var_index.end()) {
+            return nullptr;
+        }
+        return &m_vars[it->second];
+    }
+
+    void declare_var(const std::string& name, const size_t array_length = 0)
+    {
+        size_t layout = m_vars.empty() ? 0 : m_vars.back().layout;
+        for (const size_t part : { std::hash<std::string>()(name), m_stack_size, array_length }) {
+            layout = (layout ^ part) * 0x100000001b3;
+        }
+        m_var_index.emplace(name, m_vars.size());
+        m_vars.push_back({ .name = name, .stack_loc = m_stack_size, .array_length = array_length, .layout = layout });
+    }
+
+    // Reserves the slots of an array and returns how many there are.
+    // rsp is 16-byte aligned at _start and every slot is 8 bytes, so the
+    // array's lowest element is aligned exactly when the slot count after it
+    // is even; a padding slot makes it so.
+    size_t declare_array(const std::string& name, const size_t length)
+    {
+        const size_t pad = (m_stack_size + length) % 2;
+        m_stack_size += pad;
+        declare_var(name, length);
+        m_stack_size += length;
+        return pad + length;
+    }
+
+    [[nodiscard]] const Var& scalar_var(const std::string& name) const
+    {
+        const Var* var = find_var(name);
+        if (var == nullptr) {
+            std::cerr << "Undeclared identifier: " << name << std::endl;
+            compile_error();
+        }
+        if (var->array_length != 0) {
+            std::cerr << "Array used as a value: " << name << std::endl;
+            compile_error();
+        }
+        return *var;
+    }
+
+    [[nodiscard]] const Var& array_var(const std::string& name) const
+    {
+        const Var* var = find_var(name);
+        if (var == nullptr) {
+            std::cerr << "Undeclared identifier: " << name << std::endl;
+            compile_error();
+        }
+        if (var->array_length == 0) {
+            std::cerr << "Not an array: " << name << std::endl;
+            compile_error();
+        }
+        return *var;
+    }
+
+    // Offset from rsp of element 0 of an array, its lowest address.
+    [[nodiscard]] size_t array_offset(const Var& var) const
+    {
+        return (m_stack_size - var.stack_loc - var.array_length) * 8;
+    }
 
     const NodeProg m_prog;
+    const GenOptions m_options;
     std::stringstream m_output;
+    std::ostream* m_sink = nullptr;
+    size_t m_chunk_bytes = 0;
+    std::stringstream m_cold;
+    std::stringstream m_rodata;
     size_t m_stack_size = 0;
     std::vector<Var> m_vars {};
-    std::vector<size_t> m_scopes {};
+    std::unordered_map<std::string, size_t> m_var_index {};
+    std::vector<Scope> m_scopes {};
+    std::string m_label_prefix {};
     int m_label_count = 0;
+    int m_line = 0;
+    std::unordered_map<const NodeExpr*, size_t> m_cse {}; // expression -> stack_loc of its hidden local
+    std::unordered_map<const NodeExpr*, std::vector<std::string_view>> m_cse_deps {};
+    size_t m_cse_count = 0;
+    bool m_uses_print = false;
+    std::unordered_map<const void*, size_t> m_profile_slots {};
+    uint64_t m_profile_shape = 0xcbf29ce484222325;
+    std::vector<uint64_t> m_profile {};
 };
@@ -0,0 +1,747 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parser.hpp"
+
+// Precompiled AST files (.hyc).
+//
+// A .hyc holds one parsed program so it can be compiled again without being
+// lexed and parsed. All fields are 32-bit, in host byte order:
+//
+//   Header                          magic, version, section sizes, program statement list,
+//                                   source path string (or -1)
+//   Record[records]                 one per node, every node after its children
+//   int32[edges]                    statement lists of scopes and of the program
+//   StringRef[strings], bytes       interned identifier and literal text
+//
+// A record refers to another record by the (negative) difference of their
+// indices and to text by string id, so the file contains no absolute
+// positions. Because children precede their parents, a loader builds the
+// tree in one forward pass and a reference can never form a cycle. Shared
+// subexpressions (see ParseOptions::hash_cons) are written once. The source
+// path lets a -g build of the .hyc point its line info at the .hy it came from.
+namespace hyc {
+
+inline constexpr char magic[4] = { 'H', 'Y', 'C', '\0' };
+inline constexpr uint32_t version = 2;
+
+enum class Kind : uint32_t {
+    // Expressions. Binary operators are in NodeBinExpr variant order.
+    int_lit, // a: string
+    ident, // a: string
+    paren, // a: expr
+    index, // a: string, b: expr
+    add, // a: lhs, b: rhs
+    multi,
+    sub,
+    div,
+    eq,
+    // Statements.
+    exit, // a: expr
+    print, // a: expr
+    let, // a: string, b: expr
+    let_array, // a: string, b: length
+    assign, // a: string, b: expr
+    assign_index, // a: string, b: index expr, c: expr
+    scope_stmt, // a: scope
+    if_, // a: expr, b: scope, c: pred or 0
+    // Other nodes.
+    scope, // a: first edge, b: edge count
+    elif, // a: expr, b: scope, c: pred or 0
+    else_, // a: scope
+};
+
+// The source path ends up on a %line directive, which runs to the end of the
+// line, so a path with control characters is not recorded.
+[[nodiscard]] inline bool recordable_source_path(const std::string_view path)
+{
+    return std::ranges::none_of(path, [](const char c) { return std::iscntrl(static_cast<unsigned char>(c)); });
+}
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t records;
+    uint32_t edges;
+    uint32_t strings;
+    uint32_t string_bytes;
+    uint32_t prog_first_edge;
+    uint32_t prog_edges;
+    int32_t source;
+};
+
+struct Record {
+    Kind kind;
+    int32_t line;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+};
+
+struct StringRef {
+    uint32_t offset; // into the string bytes
+    uint32_t size;
+};
+
+// Serializes a parsed program.
+class Writer {
+public:
+    [[nodiscard]] std::string write(const NodeProg& prog, const std::optional<std::string>& source = {})
+    {
+        const int32_t source_id
+            = source.has_value() && recordable_source_path(source.value()) ? string(source.value()) : -1;
+        const std::vector<int32_t> stmts = write_stmts(prog.stmts);
+        const auto prog_first_edge = static_cast<uint32_t>(m_edges.size());
+        const auto count = static_cast<int32_t>(m_records.size());
+        for (const int32_t stmt : stmts) {
+            m_edges.push_back(stmt - count);
+        }
+
+        std::string string_bytes;
+        std::vector<StringRef> string_refs;
+        for (const std::string_view str : m_strings) {
+            string_refs.push_back({ static_cast<uint32_t>(string_bytes.size()), static_cast<uint32_t>(str.size()) });
+            string_bytes += str;
+        }
+        Header header {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.records = static_cast<uint32_t>(m_records.size());
+        header.edges = static_cast<uint32_t>(m_edges.size());
+        header.strings = static_cast<uint32_t>(string_refs.size());
+        header.string_bytes = static_cast<uint32_t>(string_bytes.size());
+        header.prog_first_edge = prog_first_edge;
+        header.prog_edges = static_cast<uint32_t>(stmts.size());
+        header.source = source_id;
+
+        std::string out;
+        const auto append = [&](const auto& items) {
+            out.append(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(items[0]));
+        };
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        append(m_records);
+        append(m_edges);
+        append(string_refs);
+        out += string_bytes;
+        return out;
+    }
+
+private:
+    int32_t emit(const Kind kind, const int line, const int32_t a, const int32_t b = 0, const int32_t c = 0)
+    {
+        m_records.push_back({ kind, line, a, b, c });
+        return static_cast<int32_t>(m_records.size() - 1);
+    }
+
+    // A reference from the record about to be emitted to `target`.
+    [[nodiscard]] int32_t ref(const int32_t target) const
+    {
+        return target - static_cast<int32_t>(m_records.size());
+    }
+
+    int32_t string(const std::string& str)
+    {
+        const auto [it, inserted] = m_string_ids.try_emplace(str, static_cast<int32_t>(m_strings.size()));
+        if (inserted) {
+            m_strings.push_back(str);
+        }
+        return it->second;
+    }
+
+    int32_t write_expr(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (const auto it = m_exprs.find(expr); it != m_exprs.end()) {
+            return it->second;
+        }
+        int32_t index;
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto int_lit = std::get_if<NodeTermIntLit*>(&(*term)->var)) {
+                index = emit(Kind::int_lit, expr->line, string((*int_lit)->int_lit.value.value()));
+            }
+            else if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                index = emit(Kind::ident, expr->line, string((*ident)->ident.value.value()));
+            }
+            else if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+                const int32_t inner = write_expr((*paren)->expr);
+                index = emit(Kind::paren, expr->line, ref(inner));
+            }
+            else {
+                const NodeTermIndex* term_index = std::get<NodeTermIndex*>((*term)->var);
+                const int32_t inner = write_expr(term_index->index);
+                index = emit(Kind::index, expr->line, string(term_index->ident.value.value()), ref(inner));
+            }
+        }
+        else {
+            const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+            int32_t lhs = 0;
+            int32_t rhs = 0;
+            std::visit(
+                [&](const auto* op) {
+                    lhs = write_expr(op->lhs);
+                    rhs = write_expr(op->rhs);
+                },
+                bin->var);
+            const auto kind = static_cast<Kind>(static_cast<uint32_t>(Kind::add) + bin->var.index());
+            index = emit(kind, expr->line, ref(lhs), ref(rhs));
+        }
+        m_exprs.emplace(expr, index);
+        return index;
+    }
+
+    int32_t write_scope(const NodeScope* scope) // NOLINT(*-no-recursion)
+    {
+        const std::vector<int32_t> stmts = write_stmts(scope->stmts);
+        const auto first_edge = static_cast<int32_t>(m_edges.size());
+        for (const int32_t stmt : stmts) {
+            m_edges.push_back(ref(stmt));
+        }
+        return emit(Kind::scope, 0, first_edge, static_cast<int32_t>(stmts.size()));
+    }
+
+    int32_t write_pred(const std::optional<NodeIfPred*>& pred) // NOLINT(*-no-recursion)
+    {
+        if (!pred.has_value()) {
+            return -1;
+        }
+        if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+            const int32_t expr = write_expr((*elif)->expr);
+            const int32_t scope = write_scope((*elif)->scope);
+            const int32_t next = write_pred((*elif)->pred);
+            return emit(Kind::elif, 0, ref(expr), ref(scope), next < 0 ? 0 : ref(next));
+        }
+        const int32_t scope = write_scope(std::get<NodeIfPredElse*>(pred.value()->var)->scope);
+        return emit(Kind::else_, 0, ref(scope));
+    }
+
+    std::vector<int32_t> write_stmts(const std::vector<NodeStmt*>& stmts) // NOLINT(*-no-recursion)
+    {
+        std::vector<int32_t> indices;
+        indices.reserve(stmts.size());
+        for (const NodeStmt* stmt : stmts) {
+            indices.push_back(write_stmt(stmt));
+        }
+        return indices;
+    }
+
+    int32_t write_stmt(const NodeStmt* stmt) // NOLINT(*-no-recursion)
+    {
+        const int line = stmt->line;
+        if (const auto stmt_exit = std::get_if<NodeStmtExit*>(&stmt->var)) {
+            const int32_t expr = write_expr((*stmt_exit)->expr);
+            return emit(Kind::exit, line, ref(expr));
+        }
+        if (const auto stmt_print = std::get_if<NodeStmtPrint*>(&stmt->var)) {
+            const int32_t expr = write_expr((*stmt_print)->expr);
+            return emit(Kind::print, line, ref(expr));
+        }
+        if (const auto let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            const int32_t expr = write_expr((*let)->expr);
+            return emit(Kind::let, line, string((*let)->ident.value.value()), ref(expr));
+        }
+        if (const auto let_array = std::get_if<NodeStmtLetArray*>(&stmt->var)) {
+            return emit(Kind::let_array,
+                        line,
+                        string((*let_array)->ident.value.value()),
+                        static_cast<int32_t>((*let_array)->length));
+        }
+        if (const auto assign = std::get_if<NodeStmtAssign*>(&stmt->var)) {
+            const int32_t expr = write_expr((*assign)->expr);
+            return emit(Kind::assign, line, string((*assign)->ident.value.value()), ref(expr));
+        }
+        if (const auto assign = std::get_if<NodeStmtAssignIndex*>(&stmt->var)) {
+            const int32_t index = write_expr((*assign)->index);
+            const int32_t expr = write_expr((*assign)->expr);
+            return emit(Kind::assign_index, line, string((*assign)->ident.value.value()), ref(index), ref(expr));
+        }
+        if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+            const int32_t inner = write_scope(*scope);
+            return emit(Kind::scope_stmt, line, ref(inner));
+        }
+        const NodeStmtIf* stmt_if = std::get<NodeStmtIf*>(stmt->var);
+        const int32_t expr = write_expr(stmt_if->expr);
+        const int32_t scope = write_scope(stmt_if->scope);
+        const int32_t pred = write_pred(stmt_if->pred);
+        return emit(Kind::if_, line, ref(expr), ref(scope), pred < 0 ? 0 : ref(pred));
+    }
+
+    std::vector<Record> m_records {};
+    std::vector<int32_t> m_edges {};
+    std::vector<std::string> m_strings {};
+    std::unordered_map<std::string, int32_t> m_string_ids {};
+    std::unordered_map<const NodeExpr*, int32_t> m_exprs {};
+};
+
+// A read-only private mapping of a whole file. Raises CompileError if the
+// file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st {};
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            std::cerr << "[hyc] Could not open " << path << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            compile_error();
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0) {
+            m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        }
+        close(fd);
+        if (m_data == MAP_FAILED) {
+            std::cerr << "[hyc] Could not map " << path << ": " << std::strerror(errno) << std::endl;
+            compile_error();
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        if (m_size > 0) {
+            munmap(m_data, m_size);
+        }
+    }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const
+    {
+        return { static_cast<const std::byte*>(m_size > 0 ? m_data : nullptr), m_size };
+    }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Rebuilds programs from .hyc bytes into its own arena. The nodes stay valid
+// until the next load, which rewinds the arena; they do not point into the
+// loaded bytes. Every reference, string id and literal is
+// validated, so a damaged or hostile file is rejected instead of producing
+// a broken tree (or assembly injected through an identifier).
+class Reader {
+public:
+    Reader()
+        : m_allocator(1024 * 1024 * 4) // 4 mb
+    {
+    }
+
+    // Maps `path` read-only and loads it.
+    NodeProg load_file(const std::string& path, const ParseOptions options = {})
+    {
+        const MappedFile file(path);
+        return load(file.bytes(), options);
+    }
+
+    // With options.hash_cons, structurally equal expressions are merged as
+    // the parser would have done, whatever the file was written from.
+    NodeProg load(const std::span<const std::byte> bytes, const ParseOptions options = {})
+    {
+        Header header {};
+        if (bytes.size() < sizeof(header)) {
+            corrupt("truncated header");
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+            corrupt("not a .hyc file");
+        }
+        if (header.version != version) {
+            corrupt("unsupported version " + std::to_string(header.version));
+        }
+        const uint64_t expected = sizeof(Header) + uint64_t { header.records } * sizeof(Record)
+            + uint64_t { header.edges } * sizeof(int32_t) + uint64_t { header.strings } * sizeof(StringRef)
+            + header.string_bytes;
+        if (expected != bytes.size()) {
+            corrupt("size does not match the header");
+        }
+        const std::byte* cursor = bytes.data() + sizeof(Header);
+        const auto section = [&]<typename T>(const uint32_t count) {
+            std::vector<T> items(count);
+            std::memcpy(items.data(), cursor, count * sizeof(T));
+            cursor += count * sizeof(T);
+            return items;
+        };
+        const std::vector<Record> records = section.template operator()<Record>(header.records);
+        m_edges = section.template operator()<int32_t>(header.edges);
+        const std::vector<StringRef> string_refs = section.template operator()<StringRef>(header.strings);
+        const std::string_view string_bytes(reinterpret_cast<const char*>(cursor), header.string_bytes);
+
+        m_strings.clear();
+        for (const auto& [offset, size] : string_refs) {
+            if (uint64_t { offset } + size > string_bytes.size()) {
+                corrupt("string out of range");
+            }
+            m_strings.push_back(string_bytes.substr(offset, size));
+        }
+        m_source.reset();
+        if (header.source != -1) {
+            const std::string_view source = text(header.source);
+            if (!recordable_source_path(source)) {
+                corrupt("bad source path");
+            }
+            m_source = std::string(source);
+        }
+
+        m_allocator.reset();
+        m_options = options;
+        m_interned.clear();
+        m_nodes.assign(records.size(), {});
+        for (size_t i = 0; i < records.size(); i++) {
+            m_nodes[i] = build(records[i], i);
+            m_nodes[i].shape = shape(records[i], i);
+        }
+        NodeProg prog;
+        prog.stmts = stmt_list(header.prog_first_edge, header.prog_edges, records.size());
+        uint64_t size = 0;
+        for (uint32_t i = 0; i < header.prog_edges; i++) {
+            size += m_nodes[records.size() + m_edges[header.prog_first_edge + i]].shape.size;
+        }
+        if (size > max_tree_nodes) {
+            corrupt("program too large");
+        }
+        return prog;
+    }
+
+    [[nodiscard]] const ArenaAllocator& allocator() const
+    {
+        return m_allocator;
+    }
+
+    // The absolute path of the source the last loaded file was written from,
+    // if it recorded one.
+    [[nodiscard]] const std::optional<std::string>& source_path() const
+    {
+        return m_source;
+    }
+
+private:
+    enum class Category { none, expr, stmt, scope, pred };
+
+    // Shared nodes let a small file describe a tree far larger than any
+    // source could, which the recursive passes after loading would walk in
+    // full. Trees are therefore measured as if unshared.
+    static constexpr uint64_t max_tree_nodes = 1ull << 26;
+    static constexpr uint32_t max_tree_depth = 1u << 14;
+
+    struct Shape {
+        uint64_t size = 0; // nodes when unshared
+        uint32_t depth = 0;
+    };
+
+    struct Built {
+        Category category = Category::none;
+        void* node = nullptr;
+        Shape shape {};
+    };
+
+    struct InternKey {
+        Kind kind;
+        const void* lhs;
+        const void* rhs;
+        std::string_view text;
+
+        bool operator==(const InternKey&) const = default;
+    };
+
+    struct InternKeyHash {
+        size_t operator()(const InternKey& key) const
+        {
+            size_t h = std::hash<std::string_view>()(key.text);
+            for (const size_t part : { static_cast<size_t>(key.kind),
+                                       reinterpret_cast<size_t>(key.lhs),
+                                       reinterpret_cast<size_t>(key.rhs) }) {
+                h = (h ^ part) * 0x100000001b3;
+            }
+            return h;
+        }
+    };
+
+    [[noreturn]] static void corrupt(const std::string& what)
+    {
+        std::cerr << "[hyc] Corrupt file: " << what << std::endl;
+        compile_error();
+    }
+
+    template <typename T>
+    T* node(const size_t self, const int32_t rel, const Category category) const
+    {
+        if (rel >= 0 || static_cast<size_t>(-static_cast<int64_t>(rel)) > self
+            || m_nodes[self + rel].category != category) {
+            corrupt("bad reference in record " + std::to_string(self));
+        }
+        return static_cast<T*>(m_nodes[self + rel].node);
+    }
+
+    [[nodiscard]] const std::string_view& text(const int32_t id) const
+    {
+        if (id < 0 || static_cast<size_t>(id) >= m_strings.size()) {
+            corrupt("bad string id " + std::to_string(id));
+        }
+        return m_strings[id];
+    }
+
+    [[nodiscard]] Token ident(const int32_t id, const int line) const
+    {
+        const std::string_view name = text(id);
+        if (name.empty() || !std::isalpha(static_cast<unsigned char>(name.front()))
+            || !std::ranges::all_of(name, [](const char c) { return std::isalnum(static_cast<unsigned char>(c)); })) {
+            corrupt("bad identifier");
+        }
+        return { TokenType::ident, line, std::string(name) };
+    }
+
+    [[nodiscard]] NodeTermIntLit int_lit(const int32_t id, const int line) const
+    {
+        const std::string_view digits = text(id);
+        if (digits.empty() || !std::ranges::all_of(digits, [](const char c) { return c >= '0' && c <= '9'; })) {
+            corrupt("bad integer literal");
+        }
+        const std::optional<uint64_t> value = parse_int_lit(digits);
+        if (!value.has_value()) {
+            corrupt("integer literal out of range");
+        }
+        return { { TokenType::int_lit, line, std::string(digits) }, value.value() };
+    }
+
+    std::vector<NodeStmt*> stmt_list(const uint32_t first, const uint32_t count, const size_t self) const
+    {
+        if (uint64_t { first } + count > m_edges.size()) {
+            corrupt("edge list out of range");
+        }
+        std::vector<NodeStmt*> stmts;
+        stmts.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            stmts.push_back(node<NodeStmt>(self, m_edges[first + i], Category::stmt));
+        }
+        return stmts;
+    }
+
+    std::optional<NodeIfPred*> pred(const size_t self, const int32_t rel) const
+    {
+        if (rel == 0) {
+            return {};
+        }
+        return node<NodeIfPred>(self, rel, Category::pred);
+    }
+
+    NodeExpr* expr(const Record& record, NodeTerm* term)
+    {
+        return m_allocator.emplace<NodeExpr>(term, record.line);
+    }
+
+    Built build_expr(const Record& record, const size_t self)
+    {
+        const auto sub_expr = [&](const int32_t rel) { return node<NodeExpr>(self, rel, Category::expr); };
+        InternKey key { record.kind, nullptr, nullptr, {} };
+        switch (record.kind) {
+        case Kind::int_lit:
+        case Kind::ident:
+            key.text = text(record.a);
+            break;
+        case Kind::paren:
+            key.lhs = sub_expr(record.a);
+            break;
+        case Kind::index:
+            key.text = text(record.a);
+            key.lhs = sub_expr(record.b);
+            break;
+        default:
+            key.lhs = sub_expr(record.a);
+            key.rhs = sub_expr(record.b);
+            break;
+        }
+        if (m_options.hash_cons) {
+            if (const auto it = m_interned.find(key); it != m_interned.end()) {
+                return { Category::expr, it->second };
+            }
+        }
+
+        NodeExpr* result;
+        const int line = record.line;
+        switch (record.kind) {
+        case Kind::int_lit:
+            result = expr(record, m_allocator.emplace<NodeTerm>(m_allocator.emplace<NodeTermIntLit>(int_lit(record.a, line))));
+            break;
+        case Kind::ident:
+            result = expr(record, m_allocator.emplace<NodeTerm>(m_allocator.emplace<NodeTermIdent>(ident(record.a, line))));
+            break;
+        case Kind::paren:
+            result = expr(record, m_allocator.emplace<NodeTerm>(m_allocator.emplace<NodeTermParen>(sub_expr(record.a))));
+            break;
+        case Kind::index:
+            result = expr(record,
+                          m_allocator.emplace<NodeTerm>(
+                              m_allocator.emplace<NodeTermIndex>(ident(record.a, line), sub_expr(record.b))));
+            break;
+        default: {
+            NodeExpr* lhs = sub_expr(record.a);
+            NodeExpr* rhs = sub_expr(record.b);
+            auto bin = m_allocator.emplace<NodeBinExpr>();
+            switch (record.kind) {
+            case Kind::add:
+                bin->var = m_allocator.emplace<NodeBinExprAdd>(lhs, rhs);
+                break;
+            case Kind::multi:
+                bin->var = m_allocator.emplace<NodeBinExprMulti>(lhs, rhs);
+                break;
+            case Kind::sub:
+                bin->var = m_allocator.emplace<NodeBinExprSub>(lhs, rhs);
+                break;
+            case Kind::div:
+                bin->var = m_allocator.emplace<NodeBinExprDiv>(lhs, rhs);
+                break;
+            default:
+                bin->var = m_allocator.emplace<NodeBinExprEq>(lhs, rhs);
+                break;
+            }
+            result = m_allocator.emplace<NodeExpr>(bin, line);
+            break;
+        }
+        }
+        if (m_options.hash_cons) {
+            m_interned.emplace(key, result);
+        }
+        return { Category::expr, result };
+    }
+
+    // Called after build() accepted the record, so its references are valid.
+    [[nodiscard]] Shape shape(const Record& record, const size_t self) const
+    {
+        Shape result { 1, 1 };
+        const auto add = [&](const int32_t rel) {
+            const Shape& child = m_nodes[self + rel].shape;
+            result.size += child.size;
+            result.depth = std::max(result.depth, child.depth + 1);
+        };
+        switch (record.kind) {
+        case Kind::int_lit:
+        case Kind::ident:
+        case Kind::let_array:
+            break;
+        case Kind::paren:
+        case Kind::exit:
+        case Kind::print:
+        case Kind::scope_stmt:
+        case Kind::else_:
+            add(record.a);
+            break;
+        case Kind::index:
+        case Kind::let:
+        case Kind::assign:
+            add(record.b);
+            break;
+        case Kind::assign_index:
+            add(record.b);
+            add(record.c);
+            break;
+        case Kind::if_:
+        case Kind::elif:
+            add(record.a);
+            add(record.b);
+            if (record.c != 0) {
+                add(record.c);
+            }
+            break;
+        case Kind::scope:
+            for (int32_t i = 0; i < record.b; i++) {
+                add(m_edges[record.a + i]);
+            }
+            break;
+        default:
+            add(record.a);
+            add(record.b);
+            break;
+        }
+        if (result.size > max_tree_nodes || result.depth > max_tree_depth) {
+            corrupt("tree too large in record " + std::to_string(self));
+        }
+        return result;
+    }
+
+    Built build(const Record& record, const size_t self)
+    {
+        const auto sub_expr = [&](const int32_t rel) { return node<NodeExpr>(self, rel, Category::expr); };
+        const auto sub_scope = [&](const int32_t rel) { return node<NodeScope>(self, rel, Category::scope); };
+        const auto stmt = [&](auto* inner) {
+            return Built { Category::stmt, m_allocator.emplace<NodeStmt>(inner, record.line) };
+        };
+        const int line = record.line;
+        switch (record.kind) {
+        case Kind::int_lit:
+        case Kind::ident:
+        case Kind::paren:
+        case Kind::index:
+        case Kind::add:
+        case Kind::multi:
+        case Kind::sub:
+        case Kind::div:
+        case Kind::eq:
+            return build_expr(record, self);
+        case Kind::exit:
+            return stmt(m_allocator.emplace<NodeStmtExit>(sub_expr(record.a)));
+        case Kind::print:
+            return stmt(m_allocator.emplace<NodeStmtPrint>(sub_expr(record.a)));
+        case Kind::let:
+            return stmt(m_allocator.emplace<NodeStmtLet>(ident(record.a, line), sub_expr(record.b)));
+        case Kind::let_array:
+            if (record.b <= 0 || static_cast<size_t>(record.b) > max_array_length) {
+                corrupt("bad array length");
+            }
+            return stmt(m_allocator.emplace<NodeStmtLetArray>(ident(record.a, line), static_cast<size_t>(record.b)));
+        case Kind::assign:
+            return stmt(m_allocator.emplace<NodeStmtAssign>(ident(record.a, line), sub_expr(record.b)));
+        case Kind::assign_index:
+            return stmt(
+                m_allocator.emplace<NodeStmtAssignIndex>(ident(record.a, line), sub_expr(record.b), sub_expr(record.c)));
+        case Kind::scope_stmt:
+            return stmt(sub_scope(record.a));
+        case Kind::if_:
+            return stmt(m_allocator.emplace<NodeStmtIf>(sub_expr(record.a), sub_scope(record.b), pred(self, record.c)));
+        case Kind::scope: {
+            if (record.a < 0 || record.b < 0) {
+                corrupt("bad scope");
+            }
+            auto scope = m_allocator.emplace<NodeScope>();
+            scope->stmts = stmt_list(static_cast<uint32_t>(record.a), static_cast<uint32_t>(record.b), self);
+            return { Category::scope, scope };
+        }
+        case Kind::elif: {
+            auto elif = m_allocator.emplace<NodeIfPredElif>(sub_expr(record.a), sub_scope(record.b), pred(self, record.c));
+            return { Category::pred, m_allocator.emplace<NodeIfPred>(elif) };
+        }
+        case Kind::else_: {
+            auto else_ = m_allocator.emplace<NodeIfPredElse>(sub_scope(record.a));
+            return { Category::pred, m_allocator.emplace<NodeIfPred>(else_) };
+        }
+        }
+        corrupt("unknown record kind " + std::to_string(static_cast<uint32_t>(record.kind)));
+    }
+
+    ArenaAllocator m_allocator;
+    ParseOptions m_options {};
+    std::vector<int32_t> m_edges {};
+    std::vector<std::string_view> m_strings {};
+    std::optional<std::string> m_source {};
+    std::vector<Built> m_nodes {};
+    std::unordered_map<InternKey, NodeExpr*, InternKeyHash> m_interned {};
+};
+
+} // namespace hyc
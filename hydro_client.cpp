@@ -0,0 +1,70 @@
+// Drop-in replacement for the hydro command line that hands the compile to a
+// running `hydro --serve`, so a build that invokes the compiler thousands of
+// times does not pay process startup and arena warm-up for each one.
+//
+// The arguments and working directory are sent over the server's Unix socket
+// ($HYDRO_SOCKET, or /tmp/hydro-<uid>.sock); the artifacts land in the working
+// directory as usual, and the compile's diagnostics and exit status are
+// replayed here. When no server is listening, the real compiler ($HYDRO, or
+// hydro from PATH) is exec'd with the same arguments instead.
+//
+//   g++ -std=c++20 -O2 -o hydro_client hydro_client.cpp
+//   ./hydro --serve &
+//   ./hydro_client -O1 prog.hy
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "server_protocol.hpp"
+
+static int connect_server()
+{
+    const std::filesystem::path path = server_protocol::default_socket();
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (path.native().size() >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[])
+{
+    const int fd = connect_server();
+    if (fd < 0) {
+        const char* hydro = std::getenv("HYDRO");
+        hydro = hydro != nullptr ? hydro : "hydro";
+        argv[0] = const_cast<char*>(hydro);
+        execvp(hydro, argv);
+        std::cerr << "hydro_client: no server and could not run " << hydro << ": " << std::strerror(errno)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    namespace proto = server_protocol;
+    const std::string cwd = std::filesystem::current_path().string();
+    bool sent = proto::write_u32(fd, static_cast<uint32_t>(argc)) && proto::write_string(fd, cwd);
+    for (int i = 1; sent && i < argc; i++) {
+        sent = proto::write_string(fd, argv[i]);
+    }
+    const std::optional<std::string> diagnostics = sent ? proto::read_string(fd) : std::nullopt;
+    const std::optional<uint32_t> status = diagnostics.has_value() ? proto::read_u32(fd) : std::nullopt;
+    close(fd);
+    if (!status.has_value()) {
+        std::cerr << "hydro_client: lost connection to the compile server" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cerr << diagnostics.value();
+    return static_cast<int>(status.value());
+}
@@ -1,46 +1,29 @@
-#include <fstream>
-#include <iostream>
-#include <optional>
-#include <sstream>
+#include <string>
 #include <vector>
 
-#include "generation.hpp"
+#include "compile_server.hpp"
+#include "driver.hpp"
+#include "watch.hpp"
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
-        std::cerr << "Incorrect usage. Correct usage is..." << std::endl;
-        std::cerr << "hydro <input.hy>" << std::endl;
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && args.front() == "--serve") {
+        if (args.size() == 3 && args[1] == "--socket") {
+            return CompileServer(args[2]).run();
+        }
+        if (args.size() == 1) {
+            return CompileServer(server_protocol::default_socket()).run();
+        }
+        usage();
         return EXIT_FAILURE;
     }
-
-    std::string contents;
-    {
-        std::stringstream contents_stream;
-        std::fstream input(argv[1], std::ios::in);
-        contents_stream << input.rdbuf();
-        contents = contents_stream.str();
-    }
-
-    Tokenizer tokenizer(std::move(contents));
-    std::vector<Token> tokens = tokenizer.tokenize();
-
-    Parser parser(std::move(tokens));
-    std::optional<NodeProg> prog = parser.parse_prog();
-
-    if (!prog.has_value()) {
-        std::cerr << "Invalid program" << std::endl;
-        exit(EXIT_FAILURE);
+    const std::optional<DriverOptions> opts = parse_args(args);
+    if (!opts.has_value()) {
+        return EXIT_FAILURE;
     }
-
-    {
-        Generator generator(prog.value());
-        std::fstream file("out.asm", std::ios::out);
-        file << generator.gen_prog();
+    if (opts->watch) {
+        return WatchSession(opts.value()).run();
     }
-
-    system("nasm -felf64 out.asm");
-    system("ld -o out out.o");
-
-    return EXIT_SUCCESS;
+    return Driver().compile(opts.value());
 }
@@ -0,0 +1,593 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "parser.hpp"
+
+// Evaluates an expression without free variables the way the generated code
+// would: unsigned 64-bit arithmetic that wraps, `==` yielding 0 or 1.
+// Returns nothing if the expression reads a variable or divides by zero.
+inline std::optional<uint64_t> fold_const(const NodeExpr* expr) // NOLINT(*-no-recursion)
+{
+    if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+        if (const auto int_lit = std::get_if<NodeTermIntLit*>(&(*term)->var)) {
+            return (*int_lit)->value;
+        }
+        if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+            return fold_const((*paren)->expr);
+        }
+        return {};
+    }
+    const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+    std::optional<uint64_t> lhs;
+    std::optional<uint64_t> rhs;
+    std::visit(
+        [&](const auto* op) {
+            lhs = fold_const(op->lhs);
+            rhs = fold_const(op->rhs);
+        },
+        bin->var);
+    if (!lhs.has_value() || !rhs.has_value()) {
+        return {};
+    }
+    switch (bin->var.index()) {
+    case 0:
+        return lhs.value() + rhs.value();
+    case 1:
+        return lhs.value() * rhs.value();
+    case 2:
+        return lhs.value() - rhs.value();
+    case 3:
+        if (rhs.value() == 0) {
+            return {};
+        }
+        return lhs.value() / rhs.value();
+    default:
+        return lhs.value() == rhs.value() ? 1 : 0;
+    }
+}
+
+// Liveness-driven dead code elimination, run on the AST before codegen (-O1).
+//
+// Variables are block scoped, cannot be shadowed, and there are no loops, so a
+// single backward walk over each statement list gives exact liveness. The pass
+// removes stores whose value is never read, statements that follow an
+// unconditional exit, branches whose condition is a constant, and scopes and
+// if statements that end up empty. The only observable effect an expression
+// can have is a division trap, so a store whose expression divides by
+// anything but a non-zero constant is kept even when it is dead.
+class DeadCodeEliminator {
+public:
+    void run(NodeProg& prog)
+    {
+        Names live;
+        Names mentioned;
+        sweep(prog.stmts, live, mentioned);
+    }
+
+    [[nodiscard]] size_t removed_stmts() const
+    {
+        return m_removed_stmts;
+    }
+
+private:
+    using Names = std::unordered_set<std::string_view>;
+
+    static void collect_vars(const NodeExpr* expr, Names& names) // NOLINT(*-no-recursion)
+    {
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                names.insert((*ident)->ident.value.value());
+            }
+            else if (const auto paren = std::get_if<NodeTermParen*>(&(*term)->var)) {
+                collect_vars((*paren)->expr, names);
+            }
+            else if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                names.insert((*index)->ident.value.value());
+                collect_vars((*index)->index, names);
+            }
+            return;
+        }
+        std::visit(
+            [&](const auto* op) {
+                collect_vars(op->lhs, names);
+                collect_vars(op->rhs, names);
+            },
+            std::get<NodeBinExpr*>(expr->var)->var);
+    }
+
+    // True if evaluating `expr` cannot trap.
+    static bool is_pure(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                return is_pure((*index)->index);
+            }
+            const auto paren = std::get_if<NodeTermParen*>(&(*term)->var);
+            return paren == nullptr || is_pure((*paren)->expr);
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        if (const auto div = std::get_if<NodeBinExprDiv*>(&bin->var)) {
+            const std::optional<uint64_t> divisor = fold_const((*div)->rhs);
+            if (!divisor.has_value() || divisor.value() == 0) {
+                return false;
+            }
+        }
+        bool pure = true;
+        std::visit([&](const auto* op) { pure = is_pure(op->lhs) && is_pure(op->rhs); }, bin->var);
+        return pure;
+    }
+
+    // True if control never falls through `stmt`.
+    static bool always_exits(const NodeStmt* stmt) // NOLINT(*-no-recursion)
+    {
+        if (std::holds_alternative<NodeStmtExit*>(stmt->var)) {
+            return true;
+        }
+        if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+            return std::ranges::any_of((*scope)->stmts, always_exits);
+        }
+        if (const auto stmt_if = std::get_if<NodeStmtIf*>(&stmt->var)) {
+            if (!std::ranges::any_of((*stmt_if)->scope->stmts, always_exits)) {
+                return false;
+            }
+            std::optional<NodeIfPred*> pred = (*stmt_if)->pred;
+            while (pred.has_value()) {
+                if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                    if (!std::ranges::any_of((*elif)->scope->stmts, always_exits)) {
+                        return false;
+                    }
+                    pred = (*elif)->pred;
+                }
+                else {
+                    return std::ranges::any_of(std::get<NodeIfPredElse*>(pred.value()->var)->scope->stmts, always_exits);
+                }
+            }
+            return false; // no else: every condition may be false
+        }
+        return false;
+    }
+
+    // Resolves constant conditions of an if chain in place. Returns false if
+    // the whole statement turned out to be dead.
+    static bool fold_if(NodeStmt* stmt)
+    {
+        while (const auto stmt_if = std::get_if<NodeStmtIf*>(&stmt->var)) {
+            const std::optional<uint64_t> cond = fold_const((*stmt_if)->expr);
+            if (!cond.has_value()) {
+                break;
+            }
+            if (cond.value() != 0) {
+                stmt->var = (*stmt_if)->scope;
+                return true;
+            }
+            if (!(*stmt_if)->pred.has_value()) {
+                return false;
+            }
+            NodeIfPred* pred = (*stmt_if)->pred.value();
+            if (const auto elif = std::get_if<NodeIfPredElif*>(&pred->var)) {
+                (*stmt_if)->expr = (*elif)->expr;
+                (*stmt_if)->scope = (*elif)->scope;
+                (*stmt_if)->pred = (*elif)->pred;
+            }
+            else {
+                stmt->var = std::get<NodeIfPredElse*>(pred->var)->scope;
+            }
+        }
+        const auto stmt_if = std::get_if<NodeStmtIf*>(&stmt->var);
+        if (stmt_if == nullptr) {
+            return true;
+        }
+        // Later constant conditions: a false one is skipped, a true one makes
+        // everything after it unreachable.
+        std::optional<NodeIfPred*>* link = &(*stmt_if)->pred;
+        while (link->has_value()) {
+            const auto elif = std::get_if<NodeIfPredElif*>(&link->value()->var);
+            if (elif == nullptr) {
+                break;
+            }
+            const std::optional<uint64_t> cond = fold_const((*elif)->expr);
+            if (cond.has_value() && cond.value() == 0) {
+                *link = (*elif)->pred;
+                continue;
+            }
+            if (cond.has_value()) {
+                (*elif)->pred = {};
+            }
+            link = &(*elif)->pred;
+        }
+        return true;
+    }
+
+    // Simplifies `stmts` in place. On entry `live` holds the variables read
+    // after the list and `mentioned` those referenced at all after it; on
+    // return both describe the start of the list.
+    void sweep(std::vector<NodeStmt*>& stmts, Names& live, Names& mentioned) // NOLINT(*-no-recursion)
+    {
+        size_t i = 0;
+        while (i < stmts.size()) {
+            if (!fold_if(stmts[i])) {
+                stmts.erase(stmts.begin() + static_cast<std::ptrdiff_t>(i));
+                m_removed_stmts++;
+                continue;
+            }
+            if (always_exits(stmts[i])) {
+                m_removed_stmts += stmts.size() - i - 1;
+                stmts.resize(i + 1);
+            }
+            i++;
+        }
+
+        for (size_t j = stmts.size(); j-- > 0;) {
+            if (!sweep_stmt(stmts[j], live, mentioned)) {
+                stmts.erase(stmts.begin() + static_cast<std::ptrdiff_t>(j));
+                m_removed_stmts++;
+            }
+        }
+    }
+
+    // Returns false if `stmt` should be removed.
+    bool sweep_stmt(NodeStmt* stmt, Names& live, Names& mentioned) // NOLINT(*-no-recursion)
+    {
+        if (const auto stmt_exit = std::get_if<NodeStmtExit*>(&stmt->var)) {
+            live.clear();
+            collect_vars((*stmt_exit)->expr, live);
+            collect_vars((*stmt_exit)->expr, mentioned);
+            return true;
+        }
+        if (const auto stmt_print = std::get_if<NodeStmtPrint*>(&stmt->var)) {
+            collect_vars((*stmt_print)->expr, live);
+            collect_vars((*stmt_print)->expr, mentioned);
+            return true;
+        }
+        if (const auto let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            const std::string_view name = (*let)->ident.value.value();
+            const bool dead = !live.contains(name) && is_pure((*let)->expr);
+            // A dead declaration still has to stay if a (dead) assignment
+            // after it was kept.
+            const bool keep = !dead || mentioned.contains(name);
+            live.erase(name);
+            mentioned.erase(name);
+            if (keep) {
+                collect_vars((*let)->expr, live);
+                collect_vars((*let)->expr, mentioned);
+            }
+            return keep;
+        }
+        if (const auto assign = std::get_if<NodeStmtAssign*>(&stmt->var)) {
+            const std::string_view name = (*assign)->ident.value.value();
+            if (!live.contains(name) && is_pure((*assign)->expr)) {
+                return false;
+            }
+            live.erase(name);
+            mentioned.insert(name);
+            collect_vars((*assign)->expr, live);
+            collect_vars((*assign)->expr, mentioned);
+            return true;
+        }
+        if (const auto let_array = std::get_if<NodeStmtLetArray*>(&stmt->var)) {
+            const std::string_view name = (*let_array)->ident.value.value();
+            const bool keep = mentioned.contains(name);
+            live.erase(name);
+            mentioned.erase(name);
+            return keep;
+        }
+        if (const auto assign = std::get_if<NodeStmtAssignIndex*>(&stmt->var)) {
+            // Stores one element, so the rest of the array stays live.
+            const std::string_view name = (*assign)->ident.value.value();
+            if (!live.contains(name) && is_pure((*assign)->index) && is_pure((*assign)->expr)) {
+                return false;
+            }
+            mentioned.insert(name);
+            for (const NodeExpr* expr : { (*assign)->index, (*assign)->expr }) {
+                collect_vars(expr, live);
+                collect_vars(expr, mentioned);
+            }
+            return true;
+        }
+        if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+            sweep((*scope)->stmts, live, mentioned);
+            return !(*scope)->stmts.empty();
+        }
+
+        NodeStmtIf* stmt_if = std::get<NodeStmtIf*>(stmt->var);
+        const Names live_out = std::exchange(live, {});
+        const Names mentioned_out = std::exchange(mentioned, {});
+        std::vector<const NodeExpr*> conds { stmt_if->expr };
+        bool empty = true;
+        bool has_else = false;
+        const auto sweep_branch = [&](NodeScope* scope) {
+            Names branch_live = live_out;
+            Names branch_mentioned = mentioned_out;
+            sweep(scope->stmts, branch_live, branch_mentioned);
+            live.insert(branch_live.begin(), branch_live.end());
+            mentioned.insert(branch_mentioned.begin(), branch_mentioned.end());
+            empty &= scope->stmts.empty();
+        };
+        sweep_branch(stmt_if->scope);
+        std::optional<NodeIfPred*> pred = stmt_if->pred;
+        while (pred.has_value()) {
+            if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                conds.push_back((*elif)->expr);
+                sweep_branch((*elif)->scope);
+                pred = (*elif)->pred;
+            }
+            else {
+                sweep_branch(std::get<NodeIfPredElse*>(pred.value()->var)->scope);
+                has_else = true;
+                pred = {};
+            }
+        }
+        if (!has_else) {
+            // Falls through when every condition is false.
+            live.insert(live_out.begin(), live_out.end());
+            mentioned.insert(mentioned_out.begin(), mentioned_out.end());
+        }
+        if (empty && std::ranges::all_of(conds, is_pure)) {
+            live = live_out;
+            mentioned = mentioned_out;
+            return false;
+        }
+        for (const NodeExpr* cond : conds) {
+            collect_vars(cond, live);
+            collect_vars(cond, mentioned);
+        }
+        return true;
+    }
+
+    size_t m_removed_stmts = 0;
+};
+
+// Whole-program partial evaluation (-O2).
+//
+// Programs have no inputs, so interpreting the AST at compile time usually
+// yields the exit code outright; the program is then replaced by a single
+// `exit(<code>)`. Interpretation gives up on a division by zero (which must
+// trap at run time), on a print, or when the step budget runs out. In that case the
+// top-level statements that did complete are replaced by `let`s binding each
+// top-level variable to its value at that point, and code is generated only
+// for the remainder.
+class PartialEvaluator {
+public:
+    explicit PartialEvaluator(const size_t step_budget = 10'000'000)
+        : m_budget(step_budget)
+        , m_allocator(64 * 1024)
+    {
+    }
+
+    // Rewrites `prog` in place. Returns true if it was evaluated completely.
+    bool run(NodeProg& prog)
+    {
+        for (size_t i = 0; i < prog.stmts.size(); i++) {
+            m_journal.clear();
+            m_journaled_vars = m_vars.size();
+            const Outcome outcome = exec(prog.stmts[i]);
+            if (outcome == Outcome::exit) {
+                prog.stmts = { make_exit(m_exit_code, prog.stmts[i]->line) };
+                m_folded = i + 1;
+                return true;
+            }
+            if (outcome == Outcome::stuck) {
+                // Undo the partially executed statement.
+                for (auto it = m_journal.rbegin(); it != m_journal.rend(); ++it) {
+                    m_vars[it->var].value = it->value;
+                }
+                while (m_vars.size() > m_journaled_vars) {
+                    m_index.erase(m_vars.back().name);
+                    m_vars.pop_back();
+                }
+                std::vector<NodeStmt*> residual;
+                for (const auto& [name, value] : m_vars) {
+                    residual.push_back(make_let(name, value, prog.stmts[i]->line));
+                }
+                residual.insert(residual.end(), prog.stmts.begin() + static_cast<std::ptrdiff_t>(i), prog.stmts.end());
+                prog.stmts = std::move(residual);
+                m_folded = i;
+                return false;
+            }
+        }
+        m_folded = prog.stmts.size();
+        prog.stmts = { make_exit(0, 0) };
+        return true;
+    }
+
+    [[nodiscard]] size_t folded_stmts() const
+    {
+        return m_folded;
+    }
+
+private:
+    enum class Outcome { next, exit, stuck };
+
+    struct Binding {
+        std::string_view name;
+        uint64_t value;
+    };
+
+    struct Undo {
+        size_t var;
+        uint64_t value;
+    };
+
+    std::optional<uint64_t> eval(const NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (m_steps++ == m_budget) {
+            return {};
+        }
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            if (const auto int_lit = std::get_if<NodeTermIntLit*>(&(*term)->var)) {
+                return (*int_lit)->value;
+            }
+            if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                const auto it = m_index.find((*ident)->ident.value.value());
+                if (it == m_index.end()) {
+                    return {};
+                }
+                return m_vars[it->second].value;
+            }
+            if (std::holds_alternative<NodeTermIndex*>((*term)->var)) {
+                return {}; // arrays are left to run time
+            }
+            return eval(std::get<NodeTermParen*>((*term)->var)->expr);
+        }
+        const NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+        std::optional<uint64_t> lhs;
+        std::optional<uint64_t> rhs;
+        std::visit(
+            [&](const auto* op) {
+                rhs = eval(op->rhs);
+                if (rhs.has_value()) {
+                    lhs = eval(op->lhs);
+                }
+            },
+            bin->var);
+        if (!lhs.has_value()) {
+            return {};
+        }
+        switch (bin->var.index()) {
+        case 0:
+            return lhs.value() + rhs.value();
+        case 1:
+            return lhs.value() * rhs.value();
+        case 2:
+            return lhs.value() - rhs.value();
+        case 3:
+            if (rhs.value() == 0) {
+                return {};
+            }
+            return lhs.value() / rhs.value();
+        default:
+            return lhs.value() == rhs.value() ? 1 : 0;
+        }
+    }
+
+    Outcome exec_scope(const NodeScope* scope) // NOLINT(*-no-recursion)
+    {
+        const size_t vars = m_vars.size();
+        Outcome outcome = Outcome::next;
+        for (const NodeStmt* stmt : scope->stmts) {
+            outcome = exec(stmt);
+            if (outcome != Outcome::next) {
+                break;
+            }
+        }
+        while (m_vars.size() > vars) {
+            m_index.erase(m_vars.back().name);
+            m_vars.pop_back();
+        }
+        return outcome;
+    }
+
+    Outcome exec(const NodeStmt* stmt) // NOLINT(*-no-recursion)
+    {
+        if (m_steps++ == m_budget) {
+            return Outcome::stuck;
+        }
+        if (const auto stmt_exit = std::get_if<NodeStmtExit*>(&stmt->var)) {
+            const std::optional<uint64_t> code = eval((*stmt_exit)->expr);
+            if (!code.has_value()) {
+                return Outcome::stuck;
+            }
+            m_exit_code = code.value();
+            return Outcome::exit;
+        }
+        if (std::holds_alternative<NodeStmtPrint*>(stmt->var)) {
+            // Output has to happen at run time, in order.
+            return Outcome::stuck;
+        }
+        if (std::holds_alternative<NodeStmtLetArray*>(stmt->var)
+            || std::holds_alternative<NodeStmtAssignIndex*>(stmt->var)) {
+            return Outcome::stuck;
+        }
+        if (const auto let = std::get_if<NodeStmtLet*>(&stmt->var)) {
+            const std::string_view name = (*let)->ident.value.value();
+            const std::optional<uint64_t> value = eval((*let)->expr);
+            if (!value.has_value() || m_index.contains(name)) {
+                return Outcome::stuck;
+            }
+            m_index.emplace(name, m_vars.size());
+            m_vars.push_back({ name, value.value() });
+            return Outcome::next;
+        }
+        if (const auto assign = std::get_if<NodeStmtAssign*>(&stmt->var)) {
+            const auto it = m_index.find((*assign)->ident.value.value());
+            const std::optional<uint64_t> value = eval((*assign)->expr);
+            if (it == m_index.end() || !value.has_value()) {
+                return Outcome::stuck;
+            }
+            // Variables declared during this statement are dropped on a
+            // rollback anyway (and those in inner scopes are already gone).
+            if (it->second < m_journaled_vars) {
+                m_journal.push_back({ it->second, m_vars[it->second].value });
+            }
+            m_vars[it->second].value = value.value();
+            return Outcome::next;
+        }
+        if (const auto scope = std::get_if<NodeScope*>(&stmt->var)) {
+            return exec_scope(*scope);
+        }
+        const NodeStmtIf* stmt_if = std::get<NodeStmtIf*>(stmt->var);
+        std::optional<uint64_t> cond = eval(stmt_if->expr);
+        if (!cond.has_value()) {
+            return Outcome::stuck;
+        }
+        if (cond.value() != 0) {
+            return exec_scope(stmt_if->scope);
+        }
+        std::optional<NodeIfPred*> pred = stmt_if->pred;
+        while (pred.has_value()) {
+            if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                cond = eval((*elif)->expr);
+                if (!cond.has_value()) {
+                    return Outcome::stuck;
+                }
+                if (cond.value() != 0) {
+                    return exec_scope((*elif)->scope);
+                }
+                pred = (*elif)->pred;
+            }
+            else {
+                return exec_scope(std::get<NodeIfPredElse*>(pred.value()->var)->scope);
+            }
+        }
+        return Outcome::next;
+    }
+
+    NodeExpr* make_int(const uint64_t value, const int line)
+    {
+        auto int_lit = m_allocator.emplace<NodeTermIntLit>(Token { TokenType::int_lit, line, std::to_string(value) }, value);
+        auto term = m_allocator.emplace<NodeTerm>(int_lit);
+        return m_allocator.emplace<NodeExpr>(term, line);
+    }
+
+    NodeStmt* make_exit(const uint64_t code, const int line)
+    {
+        auto stmt_exit = m_allocator.emplace<NodeStmtExit>(make_int(code, line));
+        return m_allocator.emplace<NodeStmt>(stmt_exit, line);
+    }
+
+    NodeStmt* make_let(const std::string_view name, const uint64_t value, const int line)
+    {
+        auto let = m_allocator.emplace<NodeStmtLet>(Token { TokenType::ident, line, std::string(name) },
+                                                    make_int(value, line));
+        return m_allocator.emplace<NodeStmt>(let, line);
+    }
+
+    size_t m_budget;
+    size_t m_steps = 0;
+    std::vector<Binding> m_vars {};
+    std::unordered_map<std::string_view, size_t> m_index {};
+    std::vector<Undo> m_journal {};
+    size_t m_journaled_vars = 0; // variables alive before the current top-level statement
+    uint64_t m_exit_code = 0;
+    size_t m_folded = 0;
+    ArenaAllocator m_allocator;
+};
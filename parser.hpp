@@ -1,6 +1,11 @@
 #pragma once
 
 #include <cassert>
+#include <charconv>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 #include "arena.hpp"
@@ -8,8 +13,20 @@
 
 struct NodeTermIntLit {
     Token int_lit;
+    uint64_t value = 0; // int_lit's digits, checked to fit when parsed
 };
 
+// Decimal digits as an unsigned 64-bit value; nothing if they do not fit.
+inline std::optional<uint64_t> parse_int_lit(const std::string_view digits)
+{
+    uint64_t value = 0;
+    const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (ec != std::errc {} || end != digits.data() + digits.size()) {
+        return {};
+    }
+    return value;
+}
+
 struct NodeTermIdent {
     Token ident;
 };
@@ -20,6 +37,11 @@ struct NodeTermParen {
     NodeExpr* expr;
 };
 
+struct NodeTermIndex {
+    Token ident;
+    NodeExpr* index {};
+};
+
 struct NodeBinExprAdd {
     NodeExpr* lhs;
     NodeExpr* rhs;
@@ -40,27 +62,46 @@ struct NodeBinExprDiv {
     NodeExpr* rhs;
 };
 
+struct NodeBinExprEq {
+    NodeExpr* lhs;
+    NodeExpr* rhs;
+};
+
 struct NodeBinExpr {
-    std::variant<NodeBinExprAdd*, NodeBinExprMulti*, NodeBinExprSub*, NodeBinExprDiv*> var;
+    std::variant<NodeBinExprAdd*, NodeBinExprMulti*, NodeBinExprSub*, NodeBinExprDiv*, NodeBinExprEq*> var;
 };
 
 struct NodeTerm {
-    std::variant<NodeTermIntLit*, NodeTermIdent*, NodeTermParen*> var;
+    std::variant<NodeTermIntLit*, NodeTermIdent*, NodeTermParen*, NodeTermIndex*> var;
 };
 
 struct NodeExpr {
     std::variant<NodeTerm*, NodeBinExpr*> var;
+    int line {};
 };
 
 struct NodeStmtExit {
     NodeExpr* expr;
 };
 
+struct NodeStmtPrint {
+    NodeExpr* expr;
+};
+
 struct NodeStmtLet {
     Token ident;
     NodeExpr* expr {};
 };
 
+// `let ident[length];`, zero-initialized.
+// Arrays live on the stack, so keep one well inside the default 8 MiB limit.
+inline constexpr size_t max_array_length = 512 * 1024;
+
+struct NodeStmtLetArray {
+    Token ident;
+    size_t length {}; // 1 to max_array_length elements
+};
+
 struct NodeStmt;
 
 struct NodeScope {
@@ -94,36 +135,97 @@ struct NodeStmtAssign {
     NodeExpr* expr {};
 };
 
+struct NodeStmtAssignIndex {
+    Token ident;
+    NodeExpr* index {};
+    NodeExpr* expr {};
+};
+
 struct NodeStmt {
-    std::variant<NodeStmtExit*, NodeStmtLet*, NodeScope*, NodeStmtIf*, NodeStmtAssign*> var;
+    std::variant<NodeStmtExit*,
+                 NodeStmtLet*,
+                 NodeScope*,
+                 NodeStmtIf*,
+                 NodeStmtAssign*,
+                 NodeStmtPrint*,
+                 NodeStmtLetArray*,
+                 NodeStmtAssignIndex*>
+        var;
+    int line {};
 };
 
 struct NodeProg {
     std::vector<NodeStmt*> stmts;
 };
 
+struct ParseOptions {
+    // Structurally identical expressions share one NodeExpr, so a repeated
+    // subexpression can be recognised by pointer (see Generator's CSE).
+    bool hash_cons = false;
+};
+
 class Parser {
 public:
-    explicit Parser(std::vector<Token> tokens)
+    explicit Parser(std::vector<Token> tokens, const ParseOptions options = {})
         : m_tokens(std::move(tokens))
+        , m_options(options)
         , m_allocator(1024 * 1024 * 4) // 4 mb
     {
     }
 
+    // Starts over on a new token stream. The arena is rewound and the
+    // interning tables are emptied but keep their buckets, so a long-lived
+    // parser (see the compile server) does not pay for either again. Every
+    // node from the previous parse is invalidated.
+    void reset(std::vector<Token> tokens, const ParseOptions options = {})
+    {
+        m_interned.clear();
+        m_canonical.clear();
+        m_tokens = std::move(tokens);
+        m_options = options;
+        m_index = 0;
+        m_allocator.reset();
+    }
+
+    // Moves on to another token stream but keeps the arena and interning
+    // tables, so nodes from earlier parses stay valid (see hydro --watch).
+    void append(std::vector<Token> tokens)
+    {
+        m_tokens = std::move(tokens);
+        m_index = 0;
+    }
+
     void error_expected(const std::string& msg) const
     {
         std::cerr << "[Parse Error] Expected " << msg << " on line " << peek(-1).value().line << std::endl;
-        exit(EXIT_FAILURE);
+        compile_error();
     }
 
     std::optional<NodeTerm*> parse_term() // NOLINT(*-no-recursion)
     {
         if (auto int_lit = try_consume(TokenType::int_lit)) {
-            auto term_int_lit = m_allocator.emplace<NodeTermIntLit>(int_lit.value());
+            const std::optional<uint64_t> value = parse_int_lit(int_lit.value().value.value());
+            if (!value.has_value()) {
+                std::cerr << "[Parse Error] Integer literal out of range on line " << int_lit.value().line << std::endl;
+                compile_error();
+            }
+            auto term_int_lit = m_allocator.emplace<NodeTermIntLit>(int_lit.value(), value.value());
             auto term = m_allocator.emplace<NodeTerm>(term_int_lit);
             return term;
         }
         if (auto ident = try_consume(TokenType::ident)) {
+            if (try_consume(TokenType::open_bracket)) {
+                auto term_index = m_allocator.emplace<NodeTermIndex>(ident.value());
+                if (const auto index = parse_expr()) {
+                    term_index->index = index.value();
+                }
+                else {
+                    error_expected("expression");
+                }
+                try_consume_err(TokenType::close_bracket);
+                auto term = m_allocator.emplace<NodeTerm>(term_index);
+                return term;
+            }
             auto expr_ident = m_allocator.emplace<NodeTermIdent>(ident.value());
             auto term = m_allocator.emplace<NodeTerm>(expr_ident);
             return term;
@@ -143,11 +245,12 @@ public:
 
     std::optional<NodeExpr*> parse_expr(const int min_prec = 0) // NOLINT(*-no-recursion)
     {
+        const int start_line = peek().has_value() ? peek().value().line : 0;
         std::optional<NodeTerm*> term_lhs = parse_term();
         if (!term_lhs.has_value()) {
             return {};
         }
-        auto expr_lhs = m_allocator.emplace<NodeExpr>(term_lhs.value());
+        auto expr_lhs = m_allocator.emplace<NodeExpr>(term_lhs.value(), start_line);
 
         while (true) {
             std::optional<Token> curr_tok = peek();
@@ -169,6 +272,7 @@ public:
             }
             auto expr = m_allocator.emplace<NodeBinExpr>();
             auto expr_lhs2 = m_allocator.emplace<NodeExpr>();
+            expr_lhs2->line = start_line;
             if (type == TokenType::plus) {
                 expr_lhs2->var = expr_lhs->var;
                 auto add = m_allocator.emplace<NodeBinExprAdd>(expr_lhs2, expr_rhs.value());
@@ -189,11 +293,19 @@ public:
                 auto div = m_allocator.emplace<NodeBinExprDiv>(expr_lhs2, expr_rhs.value());
                 expr->var = div;
             }
+            else if (type == TokenType::eq_eq) {
+                expr_lhs2->var = expr_lhs->var;
+                auto eq = m_allocator.emplace<NodeBinExprEq>(expr_lhs2, expr_rhs.value());
+                expr->var = eq;
+            }
             else {
                 assert(false); // Unreachable;
             }
             expr_lhs->var = expr;
         }
+        if (m_options.hash_cons && min_prec == 0) {
+            return intern(expr_lhs);
+        }
         return expr_lhs;
     }
 
@@ -214,7 +326,7 @@ public:
     {
         if (try_consume(TokenType::elif)) {
             try_consume_err(TokenType::open_paren);
-            const auto elif = m_allocator.alloc<NodeIfPredElif>();
+            const auto elif = m_allocator.emplace<NodeIfPredElif>();
             if (const auto expr = parse_expr()) {
                 elif->expr = expr.value();
             }
@@ -233,7 +345,7 @@ public:
             return pred;
         }
         if (try_consume(TokenType::else_)) {
-            auto else_ = m_allocator.alloc<NodeIfPredElse>();
+            auto else_ = m_allocator.emplace<NodeIfPredElse>();
             if (const auto scope = parse_scope()) {
                 else_->scope = scope.value();
             }
@@ -248,6 +360,7 @@ public:
 
     std::optional<NodeStmt*> parse_stmt() // NOLINT(*-no-recursion)
     {
+        const int line = peek().has_value() ? peek().value().line : 0;
         if (peek().has_value() && peek().value().type == TokenType::exit && peek(1).has_value()
             && peek(1).value().type == TokenType::open_paren) {
             consume();
@@ -263,6 +376,23 @@ public:
             try_consume_err(TokenType::semi);
             auto stmt = m_allocator.emplace<NodeStmt>();
             stmt->var = stmt_exit;
+            stmt->line = line;
+            return stmt;
+        }
+        if (peek().has_value() && peek().value().type == TokenType::print && peek(1).has_value()
+            && peek(1).value().type == TokenType::open_paren) {
+            consume();
+            consume();
+            auto stmt_print = m_allocator.emplace<NodeStmtPrint>();
+            if (const auto node_expr = parse_expr()) {
+                stmt_print->expr = node_expr.value();
+            }
+            else {
+                error_expected("expression");
+            }
+            try_consume_err(TokenType::close_paren);
+            try_consume_err(TokenType::semi);
+            auto stmt = m_allocator.emplace<NodeStmt>(stmt_print, line);
             return stmt;
         }
         if (peek().has_value() && peek().value().type == TokenType::let && peek(1).has_value()
@@ -281,11 +411,52 @@ public:
             try_consume_err(TokenType::semi);
             auto stmt = m_allocator.emplace<NodeStmt>();
             stmt->var = stmt_let;
+            stmt->line = line;
+            return stmt;
+        }
+        if (peek().has_value() && peek().value().type == TokenType::let && peek(1).has_value()
+            && peek(1).value().type == TokenType::ident && peek(2).has_value()
+            && peek(2).value().type == TokenType::open_bracket) {
+            consume();
+            auto let_array = m_allocator.emplace<NodeStmtLetArray>();
+            let_array->ident = consume();
+            consume();
+            const std::optional<uint64_t> length = parse_int_lit(try_consume_err(TokenType::int_lit).value.value());
+            if (!length.has_value() || length.value() == 0 || length.value() > max_array_length) {
+                error_expected("array length between 1 and " + std::to_string(max_array_length));
+            }
+            let_array->length = length.value();
+            try_consume_err(TokenType::close_bracket);
+            try_consume_err(TokenType::semi);
+            auto stmt = m_allocator.emplace<NodeStmt>(let_array, line);
+            return stmt;
+        }
+        if (peek().has_value() && peek().value().type == TokenType::ident && peek(1).has_value()
+            && peek(1).value().type == TokenType::open_bracket) {
+            const auto assign = m_allocator.emplace<NodeStmtAssignIndex>();
+            assign->ident = consume();
+            consume();
+            if (const auto index = parse_expr()) {
+                assign->index = index.value();
+            }
+            else {
+                error_expected("expression");
+            }
+            try_consume_err(TokenType::close_bracket);
+            try_consume_err(TokenType::eq);
+            if (const auto expr = parse_expr()) {
+                assign->expr = expr.value();
+            }
+            else {
+                error_expected("expression");
+            }
+            try_consume_err(TokenType::semi);
+            auto stmt = m_allocator.emplace<NodeStmt>(assign, line);
             return stmt;
         }
         if (peek().has_value() && peek().value().type == TokenType::ident && peek(1).has_value()
             && peek(1).value().type == TokenType::eq) {
-            const auto assign = m_allocator.alloc<NodeStmtAssign>();
+            const auto assign = m_allocator.emplace<NodeStmtAssign>();
             assign->ident = consume();
             consume();
             if (const auto expr = parse_expr()) {
@@ -295,12 +466,12 @@ public:
                 error_expected("expression");
             }
             try_consume_err(TokenType::semi);
-            auto stmt = m_allocator.emplace<NodeStmt>(assign);
+            auto stmt = m_allocator.emplace<NodeStmt>(assign, line);
             return stmt;
         }
         if (peek().has_value() && peek().value().type == TokenType::open_curly) {
             if (auto scope = parse_scope()) {
-                auto stmt = m_allocator.emplace<NodeStmt>(scope.value());
+                auto stmt = m_allocator.emplace<NodeStmt>(scope.value(), line);
                 return stmt;
             }
             error_expected("scope");
@@ -322,7 +493,7 @@ public:
                 error_expected("scope");
             }
             stmt_if->pred = parse_if_pred();
-            auto stmt = m_allocator.emplace<NodeStmt>(stmt_if);
+            auto stmt = m_allocator.emplace<NodeStmt>(stmt_if, line);
             return stmt;
         }
         return {};
@@ -342,7 +513,82 @@ public:
         return prog;
     }
 
+    [[nodiscard]] const ArenaAllocator& allocator() const
+    {
+        return m_allocator;
+    }
+
 private:
+    // Identity of an expression node: its kind, its already interned
+    // children and, for leaves, the literal or identifier text.
+    struct ExprKey {
+        size_t kind;
+        const NodeExpr* lhs;
+        const NodeExpr* rhs;
+        std::string_view text;
+
+        bool operator==(const ExprKey&) const = default;
+    };
+
+    struct ExprKeyHash {
+        size_t operator()(const ExprKey& key) const
+        {
+            size_t h = std::hash<std::string_view>()(key.text);
+            for (const size_t part : { key.kind,
+                                       reinterpret_cast<size_t>(key.lhs),
+                                       reinterpret_cast<size_t>(key.rhs) }) {
+                h = (h ^ part) * 0x100000001b3;
+            }
+            return h;
+        }
+    };
+
+    // Returns the canonical node structurally equal to `expr`, interning it
+    // (after its children) if it is the first of its shape.
+    NodeExpr* intern(NodeExpr* expr) // NOLINT(*-no-recursion)
+    {
+        if (m_canonical.contains(expr)) {
+            return expr;
+        }
+        ExprKey key {};
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            key.kind = (*term)->var.index();
+            if (const auto int_lit = std::get_if<NodeTermIntLit*>(&(*term)->var)) {
+                key.text = (*int_lit)->int_lit.value.value();
+            }
+            else if (const auto ident = std::get_if<NodeTermIdent*>(&(*term)->var)) {
+                key.text = (*ident)->ident.value.value();
+            }
+            else if (const auto index = std::get_if<NodeTermIndex*>(&(*term)->var)) {
+                (*index)->index = intern((*index)->index);
+                key.text = (*index)->ident.value.value();
+                key.lhs = (*index)->index;
+            }
+            else {
+                NodeTermParen* paren = std::get<NodeTermParen*>((*term)->var);
+                paren->expr = intern(paren->expr);
+                key.lhs = paren->expr;
+            }
+        }
+        else {
+            NodeBinExpr* bin = std::get<NodeBinExpr*>(expr->var);
+            key.kind = std::variant_size_v<decltype(NodeTerm::var)> + bin->var.index();
+            std::visit(
+                [&](auto* op) {
+                    op->lhs = intern(op->lhs);
+                    op->rhs = intern(op->rhs);
+                    key.lhs = op->lhs;
+                    key.rhs = op->rhs;
+                },
+                bin->var);
+        }
+        const auto [it, inserted] = m_interned.try_emplace(key, expr);
+        if (inserted) {
+            m_canonical.insert(expr);
+        }
+        return it->second;
+    }
+
     [[nodiscard]] std::optional<Token> peek(const int offset = 0) const
     {
         if (m_index + offset >= m_tokens.size()) {
@@ -373,7 +619,10 @@ private:
         return {};
     }
 
-    const std::vector<Token> m_tokens;
+    std::vector<Token> m_tokens;
+    ParseOptions m_options;
     size_t m_index = 0;
     ArenaAllocator m_allocator;
+    std::unordered_map<ExprKey, NodeExpr*, ExprKeyHash> m_interned {};
+    std::unordered_set<const NodeExpr*> m_canonical {};
 };
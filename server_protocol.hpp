@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+// Wire format shared by `hydro --serve` and hydro_client. A request is a
+// count followed by that many strings: the client's working directory, then
+// the hydro arguments. The reply is the text the compile wrote to stderr and
+// its exit status. Integers are 32-bit in host order (the socket is local);
+// strings are a length followed by the bytes.
+namespace server_protocol {
+
+// Limits on what a reader will accept, so a bad length prefix is rejected
+// rather than allocated.
+constexpr uint32_t max_args = 4096;
+constexpr uint32_t max_string_size = 16 * 1024 * 1024;
+
+inline std::filesystem::path default_socket()
+{
+    if (const char* path = std::getenv("HYDRO_SOCKET")) {
+        return path;
+    }
+    return "/tmp/hydro-" + std::to_string(getuid()) + ".sock";
+}
+
+inline bool write_all(const int fd, const void* data, size_t size)
+{
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool read_all(const int fd, void* data, size_t size)
+{
+    auto bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t n = read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool write_u32(const int fd, const uint32_t value)
+{
+    return write_all(fd, &value, sizeof(value));
+}
+
+inline std::optional<uint32_t> read_u32(const int fd)
+{
+    uint32_t value = 0;
+    if (!read_all(fd, &value, sizeof(value))) {
+        return {};
+    }
+    return value;
+}
+
+inline bool write_string(const int fd, const std::string_view str)
+{
+    return write_u32(fd, static_cast<uint32_t>(str.size())) && write_all(fd, str.data(), str.size());
+}
+
+inline std::optional<std::string> read_string(const int fd, const uint32_t max_size = max_string_size)
+{
+    const std::optional<uint32_t> size = read_u32(fd);
+    if (!size.has_value() || size.value() > max_size) {
+        return {};
+    }
+    std::string str(size.value(), '\0');
+    if (!read_all(fd, str.data(), str.size())) {
+        return {};
+    }
+    return str;
+}
+
+} // namespace server_protocol
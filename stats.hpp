@@ -0,0 +1,337 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "generation.hpp"
+#include "json.hpp"
+#include "parser.hpp"
+
+// Counts instructions in NASM output: indented lines that are not comments.
+// Fed incrementally so it works on chunks as well as on a whole program.
+class AsmInstrCounter {
+public:
+    void feed(const std::string_view text)
+    {
+        for (const char c : text) {
+            if (c == '\n') {
+                m_column = 0;
+                m_decided = false;
+                continue;
+            }
+            if (m_decided) {
+                continue;
+            }
+            if (m_column++ == 0 && c != ' ') {
+                m_decided = true; // label or directive
+            }
+            else if (c != ' ') {
+                m_decided = true;
+                if (c != ';') {
+                    m_count++;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t count() const
+    {
+        return m_count;
+    }
+
+private:
+    size_t m_column = 0;
+    bool m_decided = false;
+    size_t m_count = 0;
+};
+
+// Tallies AST nodes per concrete kind.
+struct AstCounter {
+    std::map<std::string, size_t>& counts;
+
+    void operator()(const NodeTermIntLit*) const
+    {
+        counts["term.int_lit"]++;
+    }
+
+    void operator()(const NodeTermIdent*) const
+    {
+        counts["term.ident"]++;
+    }
+
+    void operator()(const NodeTermParen* term_paren) const // NOLINT(*-no-recursion)
+    {
+        counts["term.paren"]++;
+        (*this)(term_paren->expr);
+    }
+
+    void operator()(const NodeTermIndex* term_index) const // NOLINT(*-no-recursion)
+    {
+        counts["term.index"]++;
+        (*this)(term_index->index);
+    }
+
+    void operator()(const NodeBinExprAdd* add) const // NOLINT(*-no-recursion)
+    {
+        counts["bin.add"]++;
+        (*this)(add->lhs);
+        (*this)(add->rhs);
+    }
+
+    void operator()(const NodeBinExprSub* sub) const // NOLINT(*-no-recursion)
+    {
+        counts["bin.sub"]++;
+        (*this)(sub->lhs);
+        (*this)(sub->rhs);
+    }
+
+    void operator()(const NodeBinExprMulti* multi) const // NOLINT(*-no-recursion)
+    {
+        counts["bin.multi"]++;
+        (*this)(multi->lhs);
+        (*this)(multi->rhs);
+    }
+
+    void operator()(const NodeBinExprDiv* div) const // NOLINT(*-no-recursion)
+    {
+        counts["bin.div"]++;
+        (*this)(div->lhs);
+        (*this)(div->rhs);
+    }
+
+    void operator()(const NodeBinExprEq* eq) const // NOLINT(*-no-recursion)
+    {
+        counts["bin.eq"]++;
+        (*this)(eq->lhs);
+        (*this)(eq->rhs);
+    }
+
+    void operator()(const NodeExpr* expr) const // NOLINT(*-no-recursion)
+    {
+        if (const auto term = std::get_if<NodeTerm*>(&expr->var)) {
+            std::visit(*this, (*term)->var);
+        }
+        else {
+            std::visit(*this, std::get<NodeBinExpr*>(expr->var)->var);
+        }
+    }
+
+    void operator()(const NodeStmtExit* stmt_exit) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.exit"]++;
+        (*this)(stmt_exit->expr);
+    }
+
+    void operator()(const NodeStmtPrint* stmt_print) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.print"]++;
+        (*this)(stmt_print->expr);
+    }
+
+    void operator()(const NodeStmtLet* stmt_let) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.let"]++;
+        (*this)(stmt_let->expr);
+    }
+
+    void operator()(const NodeStmtAssign* stmt_assign) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.assign"]++;
+        (*this)(stmt_assign->expr);
+    }
+
+    void operator()(const NodeStmtLetArray*) const
+    {
+        counts["stmt.let_array"]++;
+    }
+
+    void operator()(const NodeStmtAssignIndex* assign) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.assign_index"]++;
+        (*this)(assign->index);
+        (*this)(assign->expr);
+    }
+
+    void operator()(const NodeScope* scope) const // NOLINT(*-no-recursion)
+    {
+        counts["scope"]++;
+        for (const NodeStmt* stmt : scope->stmts) {
+            std::visit(*this, stmt->var);
+        }
+    }
+
+    void operator()(const NodeIfPredElif* elif) const // NOLINT(*-no-recursion)
+    {
+        counts["pred.elif"]++;
+        (*this)(elif->expr);
+        (*this)(elif->scope);
+        if (elif->pred.has_value()) {
+            std::visit(*this, elif->pred.value()->var);
+        }
+    }
+
+    void operator()(const NodeIfPredElse* else_) const // NOLINT(*-no-recursion)
+    {
+        counts["pred.else"]++;
+        (*this)(else_->scope);
+    }
+
+    void operator()(const NodeStmtIf* stmt_if) const // NOLINT(*-no-recursion)
+    {
+        counts["stmt.if"]++;
+        (*this)(stmt_if->expr);
+        (*this)(stmt_if->scope);
+        if (stmt_if->pred.has_value()) {
+            std::visit(*this, stmt_if->pred.value()->var);
+        }
+    }
+
+    void operator()(const NodeProg& prog) const
+    {
+        for (const NodeStmt* stmt : prog.stmts) {
+            std::visit(*this, stmt->var);
+        }
+    }
+};
+
+inline size_t ast_node_count(const NodeProg& prog)
+{
+    std::map<std::string, size_t> counts;
+    AstCounter { .counts = counts }(prog);
+    size_t nodes = 0;
+    for (const auto& [kind, count] : counts) {
+        nodes += count;
+    }
+    return nodes;
+}
+
+// Instructions the generator emits for `prog` with `options`.
+inline size_t asm_instr_count(const NodeProg& prog, GenOptions options)
+{
+    Generator generator(prog, std::move(options));
+    AsmInstrCounter counter;
+    counter.feed(generator.gen_prog());
+    return counter.count();
+}
+
+// Per-phase wall and CPU timings plus size counters for one compile.
+//
+// When disabled, `time` just calls through and nothing else is recorded, so
+// an uninstrumented compile pays a single predictable branch per phase.
+class CompileStats {
+public:
+    struct Pass {
+        std::string name;
+        double wall_ms;
+        double cpu_ms;
+    };
+
+    explicit CompileStats(const bool enabled)
+        : m_enabled(enabled)
+    {
+    }
+
+    [[nodiscard]] bool enabled() const
+    {
+        return m_enabled;
+    }
+
+    template <typename F>
+    decltype(auto) time(const std::string_view name, F&& f)
+    {
+        if (!m_enabled) {
+            return f();
+        }
+        const auto wall_start = std::chrono::steady_clock::now();
+        const double cpu_start = cpu_ms();
+        struct Record {
+            CompileStats& stats;
+            std::string_view name;
+            std::chrono::steady_clock::time_point wall_start;
+            double cpu_start;
+
+            ~Record()
+            {
+                const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wall_start;
+                stats.m_passes.push_back({ std::string(name), wall.count(), cpu_ms() - cpu_start });
+            }
+        } record { *this, name, wall_start, cpu_start };
+        return f();
+    }
+
+    void set(const std::string& counter, const uint64_t value)
+    {
+        m_counters[counter] = value;
+    }
+
+    void count_ast(const NodeProg& prog)
+    {
+        AstCounter { .counts = m_ast_nodes }(prog);
+    }
+
+    void print(std::ostream& out) const
+    {
+        double wall_total = 0;
+        double cpu_total = 0;
+        out << "===== hydro pass timings =====\n";
+        out << std::fixed << std::setprecision(3);
+        out << std::setw(12) << "Wall (ms)" << std::setw(12) << "CPU (ms)" << "  Pass\n";
+        for (const auto& [name, wall_ms, cpu] : m_passes) {
+            out << std::setw(12) << wall_ms << std::setw(12) << cpu << "  " << name << "\n";
+            wall_total += wall_ms;
+            cpu_total += cpu;
+        }
+        out << std::setw(12) << wall_total << std::setw(12) << cpu_total << "  Total\n";
+        out << "===== hydro statistics =====\n";
+        for (const auto& [name, value] : m_counters) {
+            out << std::setw(12) << value << "  " << name << "\n";
+        }
+        size_t nodes = 0;
+        for (const auto& [kind, count] : m_ast_nodes) {
+            out << std::setw(12) << count << "  ast." << kind << "\n";
+            nodes += count;
+        }
+        out << std::setw(12) << nodes << "  ast nodes\n";
+        out << std::defaultfloat;
+    }
+
+    [[nodiscard]] nlohmann::json to_json() const
+    {
+        nlohmann::json passes = nlohmann::json::array();
+        for (const auto& [name, wall_ms, cpu] : m_passes) {
+            passes.push_back({ { "name", name }, { "wall_ms", wall_ms }, { "cpu_ms", cpu } });
+        }
+        return {
+            { "passes", passes },
+            { "counters", m_counters },
+            { "ast_nodes", m_ast_nodes },
+        };
+    }
+
+private:
+    // CPU time of this process plus all reaped children (nasm and ld run as children).
+    static double cpu_ms()
+    {
+        timespec self {};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &self);
+        rusage children {};
+        getrusage(RUSAGE_CHILDREN, &children);
+        const auto tv_ms = [](const timeval& tv) { return tv.tv_sec * 1e3 + tv.tv_usec / 1e3; };
+        return self.tv_sec * 1e3 + self.tv_nsec / 1e6 + tv_ms(children.ru_utime) + tv_ms(children.ru_stime);
+    }
+
+    bool m_enabled;
+    std::vector<Pass> m_passes {};
+    std::map<std::string, uint64_t> m_counters {};
+    std::map<std::string, size_t> m_ast_nodes {};
+};
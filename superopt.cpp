@@ -0,0 +1,672 @@
+// Offline superoptimizer for the arithmetic shapes the accumulator code
+// generator (Generator::gen_acc) lowers most often:
+//
+//   mul          x * k
+//   offset_mul   (x + c) * d, (x - c) * d    (c < 0 for subtraction)
+//   lin_comb     x * k1 + y * k2, x * k1 - y * k2    (k2 < 0 for subtraction)
+//
+// with x in rax, y in rbx and the result in rax. For every shape and
+// constant in range it searches all sequences of up to three mov, add, sub,
+// shl, imul and lea instructions over rax and rbx for the cheapest one, and
+// keeps it if it beats what emit_alu would generate. Registers are tracked as
+// linear forms a*x + b*y + c (mod 2^64), so a sequence computes the shape for
+// all inputs exactly when its final rax form equals the shape's. The assembly
+// text of every kept sequence is then checked once more by interpreting it
+// against the Generator's 64-bit wrapping semantics: exhaustively for small
+// inputs and on random and edge-case 64-bit ones.
+//
+// Costs are latency sums (imul 3, a three-component lea 3, everything else
+// 1), ties broken by instruction count, so "cheapest" is within this model and
+// this instruction set. The result is written as superopt_table.hpp, which is
+// committed; rerun this after changing the model, the ranges or emit_alu.
+//
+//   g++ -std=c++20 -O2 -o superopt superopt.cpp
+//   ./superopt [--out superopt_table.hpp]
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// a*x + b*y + c, mod 2^64.
+struct Form {
+    uint64_t x = 0;
+    uint64_t y = 0;
+    uint64_t c = 0;
+
+    bool operator==(const Form&) const = default;
+
+    Form operator+(const Form& other) const
+    {
+        return { x + other.x, y + other.y, c + other.c };
+    }
+
+    Form operator-(const Form& other) const
+    {
+        return { x - other.x, y - other.y, c - other.c };
+    }
+
+    Form operator*(const uint64_t k) const
+    {
+        return { x * k, y * k, c * k };
+    }
+};
+
+enum class Reg : uint8_t { rax, rbx, none };
+enum class Op : uint8_t { mov, add, sub, shl, imul, lea };
+
+// mov/add/sub dst, src; shl dst, imm; imul dst, src, imm;
+// lea dst, [src + index * scale + imm] (src or index may be none).
+struct Insn {
+    Op op;
+    Reg dst;
+    Reg src = Reg::none;
+    Reg index = Reg::none;
+    uint64_t scale = 1;
+    int64_t imm = 0;
+};
+
+struct Cost {
+    int latency = 0;
+    int count = 0;
+
+    auto operator<=>(const Cost&) const = default;
+
+    Cost operator+(const Cost& other) const
+    {
+        return { latency + other.latency, count + other.count };
+    }
+};
+
+using Regs = std::array<Form, 2>;
+
+const char* reg_name(const Reg reg)
+{
+    return reg == Reg::rax ? "rax" : "rbx";
+}
+
+Cost cost(const Insn& insn)
+{
+    if (insn.op == Op::imul) {
+        return { 3, 1 };
+    }
+    if (insn.op == Op::lea && insn.src != Reg::none && insn.index != Reg::none && insn.imm != 0) {
+        return { 3, 1 };
+    }
+    return { 1, 1 };
+}
+
+Form operand(const Regs& regs, const Reg reg)
+{
+    return reg == Reg::none ? Form {} : regs[static_cast<size_t>(reg)];
+}
+
+void apply(const Insn& insn, Regs& regs)
+{
+    Form& dst = regs[static_cast<size_t>(insn.dst)];
+    const Form src = operand(regs, insn.src);
+    switch (insn.op) {
+    case Op::mov:
+        dst = src;
+        break;
+    case Op::add:
+        dst = dst + src;
+        break;
+    case Op::sub:
+        dst = dst - src;
+        break;
+    case Op::shl:
+        dst = dst * (uint64_t { 1 } << insn.imm);
+        break;
+    case Op::imul:
+        dst = src * static_cast<uint64_t>(insn.imm);
+        break;
+    case Op::lea:
+        dst = src + operand(regs, insn.index) * insn.scale + Form { 0, 0, static_cast<uint64_t>(insn.imm) };
+        break;
+    }
+}
+
+// In the Generator's notation, e.g. "    lea rax, [rax + rbx * 4 - 8]\n".
+std::string format(const Insn& insn)
+{
+    std::ostringstream out;
+    out << "    ";
+    switch (insn.op) {
+    case Op::mov:
+    case Op::add:
+    case Op::sub:
+        out << (insn.op == Op::mov ? "mov " : insn.op == Op::add ? "add " : "sub ") << reg_name(insn.dst) << ", "
+            << reg_name(insn.src);
+        break;
+    case Op::shl:
+        out << "shl " << reg_name(insn.dst) << ", " << insn.imm;
+        break;
+    case Op::imul:
+        out << "imul " << reg_name(insn.dst) << ", " << reg_name(insn.src) << ", " << insn.imm;
+        break;
+    case Op::lea: {
+        out << "lea " << reg_name(insn.dst) << ", [";
+        bool first = true;
+        if (insn.src != Reg::none) {
+            out << reg_name(insn.src);
+            first = false;
+        }
+        if (insn.index != Reg::none) {
+            out << (first ? "" : " + ") << reg_name(insn.index) << " * " << insn.scale;
+            first = false;
+        }
+        if (insn.imm != 0) {
+            out << (insn.imm < 0 ? " - " : " + ") << (insn.imm < 0 ? -insn.imm : insn.imm);
+        }
+        out << "]";
+        break;
+    }
+    }
+    out << "\n";
+    return out.str();
+}
+
+bool fits_imm32(const int64_t value)
+{
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+enum class Shape : uint8_t { mul, offset_mul, lin_comb };
+
+struct Entry {
+    Shape shape;
+    int64_t k1;
+    int64_t k2;
+    std::vector<Insn> code;
+    Cost cost;
+};
+
+// Exhaustive search for the cheapest sequence that leaves `target` in rax.
+// Only sequences strictly cheaper than `bound` are reported.
+class Search {
+public:
+    Search(const Form target, const Cost bound, const std::vector<int64_t>& constants)
+        : m_target(target)
+        , m_best_cost(bound)
+    {
+        std::vector<int64_t> disps { 0 };
+        std::vector<int64_t> factors;
+        for (const int64_t k : constants) {
+            if (k != 0 && fits_imm32(k) && std::ranges::find(disps, k) == disps.end()) {
+                disps.push_back(k);
+            }
+            if (k > 1 && fits_imm32(k) && std::ranges::find(factors, k) == factors.end()) {
+                factors.push_back(k);
+            }
+        }
+        for (const Reg dst : { Reg::rax, Reg::rbx }) {
+            for (const Reg src : { Reg::rax, Reg::rbx }) {
+                if (src != dst) {
+                    m_moves.push_back({ Op::mov, dst, src });
+                }
+                m_moves.push_back({ Op::add, dst, src });
+                if (src != dst) {
+                    m_moves.push_back({ Op::sub, dst, src });
+                }
+                for (const int64_t k : factors) {
+                    m_moves.push_back({ Op::imul, dst, src, Reg::none, 1, k });
+                }
+            }
+            for (int64_t n = 1; n <= max_shift; n++) {
+                m_moves.push_back({ Op::shl, dst, Reg::none, Reg::none, 1, n });
+            }
+            for (const Insn& lea : leas(dst)) {
+                for (const int64_t disp : disps) {
+                    if (lea.index != Reg::none || disp != 0) {
+                        m_moves.push_back({ Op::lea, dst, lea.src, lea.index, lea.scale, disp });
+                    }
+                }
+            }
+        }
+    }
+
+    std::optional<std::pair<std::vector<Insn>, Cost>> run()
+    {
+        std::vector<Insn> path;
+        dfs({ Form { 1, 0, 0 }, Form { 0, 1, 0 } }, {}, path);
+        if (!m_best.has_value()) {
+            return {};
+        }
+        return std::pair { m_best.value(), m_best_cost };
+    }
+
+private:
+    static constexpr int max_length = 3;
+    static constexpr int64_t max_shift = 12;
+
+    // The register shapes of lea: [base + index * scale], displacement aside.
+    static std::vector<Insn> leas(const Reg dst)
+    {
+        std::vector<Insn> result;
+        for (const Reg base : { Reg::none, Reg::rax, Reg::rbx }) {
+            for (const Reg index : { Reg::none, Reg::rax, Reg::rbx }) {
+                for (const uint64_t scale : { 1, 2, 4, 8 }) {
+                    // [index * 1] is written [index]; [base] needs no scale.
+                    if ((base == Reg::none && (index == Reg::none || scale == 1))
+                        || (index == Reg::none && scale != 1)) {
+                        continue;
+                    }
+                    result.push_back({ Op::lea, dst, base, index, scale, 0 });
+                }
+            }
+        }
+        return result;
+    }
+
+    void consider(const std::vector<Insn>& path, const Cost cost)
+    {
+        if (cost < m_best_cost) {
+            m_best_cost = cost;
+            m_best = path;
+        }
+    }
+
+    // Every single instruction that turns `regs` into the target, found by
+    // solving for its immediate instead of enumerating immediates.
+    void finish(const Regs& regs, const Cost cost, std::vector<Insn>& path)
+    {
+        const auto try_insn = [&](const Insn& insn) {
+            Regs next = regs;
+            apply(insn, next);
+            if (next[0] == m_target) {
+                path.push_back(insn);
+                consider(path, cost + ::cost(insn));
+                path.pop_back();
+            }
+        };
+        for (const Reg src : { Reg::rax, Reg::rbx }) {
+            if (src != Reg::rax) {
+                try_insn({ Op::mov, Reg::rax, src });
+            }
+            try_insn({ Op::sub, Reg::rax, src });
+            try_insn({ Op::add, Reg::rax, src });
+            // imul: the immediate is the ratio of any lane that divides evenly.
+            const Form s = operand(regs, src);
+            const std::array<std::pair<uint64_t, uint64_t>, 3> lanes { { { s.x, m_target.x },
+                                                                         { s.y, m_target.y },
+                                                                         { s.c, m_target.c } } };
+            for (const auto& [from, to] : lanes) {
+                const auto signed_from = static_cast<int64_t>(from);
+                const auto signed_to = static_cast<int64_t>(to);
+                if (signed_from != 0 && signed_from != -1 && signed_to % signed_from == 0
+                    && fits_imm32(signed_to / signed_from)) {
+                    try_insn({ Op::imul, Reg::rax, src, Reg::none, 1, signed_to / signed_from });
+                }
+            }
+        }
+        for (int64_t n = 1; n < 64; n++) {
+            try_insn({ Op::shl, Reg::rax, Reg::none, Reg::none, 1, n });
+        }
+        // lea: whatever the registers leave over must be a 32-bit displacement.
+        for (const Insn& lea : leas(Reg::rax)) {
+            const Form rest = m_target - (operand(regs, lea.src) + operand(regs, lea.index) * lea.scale);
+            const auto disp = static_cast<int64_t>(rest.c);
+            if (rest.x == 0 && rest.y == 0 && fits_imm32(disp) && (lea.index != Reg::none || disp != 0)) {
+                try_insn({ Op::lea, Reg::rax, lea.src, lea.index, lea.scale, disp });
+            }
+        }
+    }
+
+    void dfs(const Regs& regs, const Cost cost, std::vector<Insn>& path) // NOLINT(*-no-recursion)
+    {
+        if (regs[0] == m_target) {
+            consider(path, cost);
+            return;
+        }
+        if (static_cast<int>(path.size()) + 1 > max_length || !(cost + Cost { 1, 1 } < m_best_cost)) {
+            return;
+        }
+        finish(regs, cost, path);
+        if (static_cast<int>(path.size()) + 2 > max_length) {
+            return;
+        }
+        for (const Insn& insn : m_moves) {
+            const Cost next_cost = cost + ::cost(insn);
+            // At least one more instruction follows.
+            if (!(next_cost + Cost { 1, 1 } < m_best_cost)) {
+                continue;
+            }
+            Regs next = regs;
+            apply(insn, next);
+            if (next == regs) {
+                continue;
+            }
+            path.push_back(insn);
+            dfs(next, next_cost, path);
+            path.pop_back();
+        }
+    }
+
+    Form m_target;
+    Cost m_best_cost;
+    std::optional<std::vector<Insn>> m_best {};
+    std::vector<Insn> m_moves {};
+};
+
+// Assembly text in the Generator's notation, parsed once and then run on
+// rax = x, rbx = y. Deliberately independent of Insn and Form, so that it
+// checks the text that goes into the table rather than the search's model
+// of it.
+class TextProgram {
+public:
+    explicit TextProgram(const std::string& code)
+    {
+        std::istringstream lines(code);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::string text;
+            for (const char c : line) {
+                if (c != ',' && c != '[' && c != ']') {
+                    text += c;
+                }
+            }
+            std::istringstream words(text);
+            Step step;
+            std::string dst;
+            words >> step.mnemonic >> dst;
+            step.dst = reg(dst);
+            std::vector<std::string> rest;
+            for (std::string word; words >> word;) {
+                rest.push_back(word);
+            }
+            // Operands as a sum of terms; shl, imul and lea are all sums.
+            if (step.mnemonic == "shl") {
+                step.terms.push_back({ step.dst, uint64_t { 1 } << std::stoi(rest.at(0)) });
+            }
+            else if (step.mnemonic == "imul") {
+                step.terms.push_back({ reg(rest.at(0)), static_cast<uint64_t>(std::stoll(rest.at(1))) });
+            }
+            else if (step.mnemonic == "lea") {
+                // term (("+" | "-") term)*, where a term is reg, reg * scale or a number.
+                bool negate = false;
+                for (size_t i = 0; i < rest.size(); i++) {
+                    if (rest[i] == "+" || rest[i] == "-") {
+                        negate = rest[i] == "-";
+                        continue;
+                    }
+                    Term term { -1, 1 };
+                    if (rest[i] == "rax" || rest[i] == "rbx") {
+                        term.reg = reg(rest[i]);
+                        if (i + 2 < rest.size() && rest[i + 1] == "*") {
+                            term.factor = std::stoull(rest[i + 2]);
+                            i += 2;
+                        }
+                    }
+                    else {
+                        term.factor = std::stoull(rest[i]);
+                    }
+                    term.factor = negate ? -term.factor : term.factor;
+                    step.terms.push_back(term);
+                }
+            }
+            else if (step.mnemonic == "mov" || step.mnemonic == "add" || step.mnemonic == "sub") {
+                step.terms.push_back({ reg(rest.at(0)), 1 });
+            }
+            else {
+                throw std::runtime_error("unknown instruction " + line);
+            }
+            m_steps.push_back(std::move(step));
+        }
+    }
+
+    [[nodiscard]] uint64_t run(const uint64_t x, const uint64_t y) const
+    {
+        std::array<uint64_t, 2> regs { x, y };
+        for (const Step& step : m_steps) {
+            uint64_t value = 0;
+            for (const auto& [reg, factor] : step.terms) {
+                value += (reg < 0 ? 1 : regs[reg]) * factor;
+            }
+            if (step.mnemonic == "add") {
+                regs[step.dst] += value;
+            }
+            else if (step.mnemonic == "sub") {
+                regs[step.dst] -= value;
+            }
+            else {
+                regs[step.dst] = value;
+            }
+        }
+        return regs[0];
+    }
+
+private:
+    struct Term {
+        int reg; // -1: a constant
+        uint64_t factor;
+    };
+
+    struct Step {
+        std::string mnemonic;
+        int dst = 0;
+        std::vector<Term> terms;
+    };
+
+    static int reg(const std::string& name)
+    {
+        if (name == "rax") {
+            return 0;
+        }
+        if (name == "rbx") {
+            return 1;
+        }
+        throw std::runtime_error("unknown register " + name);
+    }
+
+    std::vector<Step> m_steps {};
+};
+
+uint64_t reference(const Entry& entry, const uint64_t x, const uint64_t y)
+{
+    const auto k1 = static_cast<uint64_t>(entry.k1);
+    const auto k2 = static_cast<uint64_t>(entry.k2);
+    switch (entry.shape) {
+    case Shape::mul:
+        return x * k1;
+    case Shape::offset_mul:
+        return (x + k1) * k2;
+    case Shape::lin_comb:
+        return x * k1 + y * k2;
+    }
+    return 0;
+}
+
+bool verify(const Entry& entry, std::mt19937_64& rng)
+{
+    std::string code;
+    for (const Insn& insn : entry.code) {
+        code += format(insn);
+    }
+    const TextProgram program(code);
+    const auto check = [&](const uint64_t x, const uint64_t y) {
+        return program.run(x, y) == reference(entry, x, y);
+    };
+    for (int64_t x = -128; x < 128; x++) {
+        for (int64_t y = -128; y < 128; y++) {
+            if (!check(static_cast<uint64_t>(x), static_cast<uint64_t>(y))) {
+                return false;
+            }
+        }
+    }
+    constexpr std::array<uint64_t, 8> edges { 0, 1, uint64_t { 1 } << 31, uint64_t { 1 } << 32, uint64_t { 1 } << 63,
+                                              (uint64_t { 1 } << 63) - 1, UINT64_MAX, UINT64_MAX - 1 };
+    for (const uint64_t x : edges) {
+        for (const uint64_t y : edges) {
+            if (!check(x, y)) {
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < 100'000; i++) {
+        if (!check(rng(), rng())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// What emit_alu does for `rax * k`.
+Cost default_mul_cost(const int64_t k)
+{
+    if (k == 2 || k == 3 || k == 4 || k == 5 || k == 8 || k == 9) {
+        return { 1, 1 };
+    }
+    return { 3, 1 };
+}
+
+constexpr int64_t max_mul = 1024;
+constexpr int64_t max_offset = 16;
+constexpr int64_t max_offset_factor = 32;
+constexpr int64_t max_lin_factor = 16;
+
+const char* shape_name(const Shape shape)
+{
+    switch (shape) {
+    case Shape::mul:
+        return "mul";
+    case Shape::offset_mul:
+        return "offset_mul";
+    case Shape::lin_comb:
+        return "lin_comb";
+    }
+    return "";
+}
+
+void write_table(std::ostream& out, const std::vector<Entry>& entries)
+{
+    out << "#pragma once\n\n";
+    out << "// Generated by superopt.cpp; do not edit. Cheapest known instruction sequences\n";
+    out << "// for small arithmetic shapes, with x in rax, y in rbx and the result in rax\n";
+    out << "// (rbx is clobbered). Entries exist only where they beat emit_alu's default.\n";
+    out << "//\n";
+    out << "//   mul          x * k1\n";
+    out << "//   offset_mul   (x + k1) * k2\n";
+    out << "//   lin_comb     x * k1 + y * k2\n";
+    out << "\n";
+    out << "#include <algorithm>\n";
+    out << "#include <array>\n";
+    out << "#include <cstdint>\n";
+    out << "#include <string_view>\n";
+    out << "#include <tuple>\n";
+    out << "\n";
+    out << "enum class SuperoptShape : uint8_t { mul, offset_mul, lin_comb };\n";
+    out << "\n";
+    out << "struct SuperoptEntry {\n";
+    out << "    SuperoptShape shape;\n";
+    out << "    int64_t k1;\n";
+    out << "    int64_t k2;\n";
+    out << "    std::string_view code;\n";
+    out << "};\n";
+    out << "\n";
+    out << "inline constexpr std::array<SuperoptEntry, " << entries.size() << "> superopt_table { {\n";
+    for (const Entry& entry : entries) {
+        std::string code;
+        for (const Insn& insn : entry.code) {
+            code += format(insn);
+        }
+        std::string escaped;
+        for (const char c : code) {
+            escaped += c == '\n' ? "\\n" : std::string(1, c);
+        }
+        out << "    { SuperoptShape::" << shape_name(entry.shape) << ", " << entry.k1 << ", " << entry.k2 << ", \""
+            << escaped << "\" },\n";
+    }
+    out << "} };\n";
+    out << "\n";
+    out << "// The entry for `shape` with these constants, if the search found one.\n";
+    out << "inline const SuperoptEntry* superopt_lookup(const SuperoptShape shape, const int64_t k1, const int64_t k2)\n";
+    out << "{\n";
+    out << "    const auto key = [](const SuperoptEntry& e) { return std::tuple { e.shape, e.k1, e.k2 }; };\n";
+    out << "    const auto it = std::ranges::lower_bound(superopt_table, std::tuple { shape, k1, k2 }, {}, key);\n";
+    out << "    if (it == superopt_table.end() || key(*it) != std::tuple { shape, k1, k2 }) {\n";
+    out << "        return nullptr;\n";
+    out << "    }\n";
+    out << "    return &*it;\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string out_path = "superopt_table.hpp";
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        }
+        else {
+            std::cerr << "superopt [--out <file>]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Entry> entries;
+    // The cost of `rax * k` once the mul entries are in use, which is what
+    // the other shapes have to beat.
+    std::vector<Cost> mul_cost(max_mul + 1);
+    const auto search = [&](const Shape shape, const int64_t k1, const int64_t k2, const Form target, const Cost bound) {
+        if (auto found = Search(target, bound, { k1, k2, k1 * k2 }).run()) {
+            entries.push_back({ shape, k1, k2, std::move(found->first), found->second });
+            return found->second;
+        }
+        return bound;
+    };
+
+    for (int64_t k = 0; k <= max_mul; k++) {
+        mul_cost[k] = search(Shape::mul, k, 0, Form { static_cast<uint64_t>(k), 0, 0 }, default_mul_cost(k));
+    }
+    for (int64_t c = -max_offset; c <= max_offset; c++) {
+        for (int64_t d = 2; d <= max_offset_factor && c != 0; d++) {
+            // lea rax, [rax + c] or sub rax, -c, then the multiplication.
+            const Form target { static_cast<uint64_t>(d), 0, static_cast<uint64_t>(c * d) };
+            search(Shape::offset_mul, c, d, target, Cost { 1, 1 } + mul_cost[d]);
+        }
+    }
+    for (int64_t k1 = 1; k1 <= max_lin_factor; k1++) {
+        for (int64_t k2 = -max_lin_factor; k2 <= max_lin_factor; k2++) {
+            if (k2 == 0) {
+                continue;
+            }
+            // Both multiplications, then add or sub; moving y into place is not counted.
+            const Cost bound = mul_cost[k1] + mul_cost[std::abs(k2)] + Cost { 1, 1 };
+            search(Shape::lin_comb, k1, k2, Form { static_cast<uint64_t>(k1), static_cast<uint64_t>(k2), 0 }, bound);
+        }
+    }
+
+    std::mt19937_64 rng(0x5eed);
+    for (const Entry& entry : entries) {
+        if (!verify(entry, rng)) {
+            std::cerr << "Verification failed for " << shape_name(entry.shape) << " " << entry.k1 << " " << entry.k2
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ranges::sort(entries, {}, [](const Entry& e) { return std::tuple { e.shape, e.k1, e.k2 }; });
+
+    std::ofstream out(out_path);
+    write_table(out, entries);
+    if (!out.flush()) {
+        std::cerr << "Could not write " << out_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cerr << entries.size() << " entries written to " << out_path << std::endl;
+    return EXIT_SUCCESS;
+}
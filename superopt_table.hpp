@@ -0,0 +1,853 @@
+#pragma once
+
+// Generated by superopt.cpp; do not edit. Cheapest known instruction sequences
+// for small arithmetic shapes, with x in rax, y in rbx and the result in rax
+// (rbx is clobbered). Entries exist only where they beat emit_alu's default.
+//
+//   mul          x * k1
+//   offset_mul   (x + k1) * k2
+//   lin_comb     x * k1 + y * k2
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+
+enum class SuperoptShape : uint8_t { mul, offset_mul, lin_comb };
+
+struct SuperoptEntry {
+    SuperoptShape shape;
+    int64_t k1;
+    int64_t k2;
+    std::string_view code;
+};
+
+inline constexpr std::array<SuperoptEntry, 815> superopt_table { {
+    { SuperoptShape::mul, 0, 0, "    sub rax, rax\n" },
+    { SuperoptShape::mul, 1, 0, "" },
+    { SuperoptShape::mul, 6, 0, "    add rax, rax\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 7, 0, "    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::mul, 10, 0, "    add rax, rax\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 11, 0, "    lea rbx, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::mul, 12, 0, "    shl rax, 2\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 13, 0, "    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::mul, 15, 0, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 16, 0, "    shl rax, 4\n" },
+    { SuperoptShape::mul, 17, 0, "    lea rbx, [rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::mul, 18, 0, "    add rax, rax\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 19, 0, "    lea rbx, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::mul, 20, 0, "    shl rax, 2\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 21, 0, "    lea rbx, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::mul, 24, 0, "    shl rax, 3\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 25, 0, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 27, 0, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 32, 0, "    shl rax, 5\n" },
+    { SuperoptShape::mul, 33, 0, "    lea rbx, [rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::mul, 36, 0, "    shl rax, 2\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 37, 0, "    lea rbx, [rax + rax * 8]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::mul, 40, 0, "    shl rax, 3\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 41, 0, "    lea rbx, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::mul, 45, 0, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 48, 0, "    shl rax, 4\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 64, 0, "    shl rax, 6\n" },
+    { SuperoptShape::mul, 65, 0, "    lea rbx, [rax * 8]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::mul, 72, 0, "    shl rax, 3\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 73, 0, "    lea rbx, [rax + rax * 8]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::mul, 80, 0, "    shl rax, 4\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 81, 0, "    lea rax, [rax + rax * 8]\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 96, 0, "    shl rax, 5\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 128, 0, "    shl rax, 7\n" },
+    { SuperoptShape::mul, 144, 0, "    shl rax, 4\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 160, 0, "    shl rax, 5\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 192, 0, "    shl rax, 6\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 256, 0, "    shl rax, 8\n" },
+    { SuperoptShape::mul, 288, 0, "    shl rax, 5\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 320, 0, "    shl rax, 6\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 384, 0, "    shl rax, 7\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 512, 0, "    shl rax, 9\n" },
+    { SuperoptShape::mul, 576, 0, "    shl rax, 6\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::mul, 640, 0, "    shl rax, 7\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::mul, 768, 0, "    shl rax, 8\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::mul, 1024, 0, "    shl rax, 10\n" },
+    { SuperoptShape::offset_mul, -16, 2, "    lea rax, [rax * 2 - 32]\n" },
+    { SuperoptShape::offset_mul, -16, 4, "    lea rax, [rax * 4 - 64]\n" },
+    { SuperoptShape::offset_mul, -16, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 96]\n" },
+    { SuperoptShape::offset_mul, -16, 8, "    lea rax, [rax * 8 - 128]\n" },
+    { SuperoptShape::offset_mul, -16, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 160]\n" },
+    { SuperoptShape::offset_mul, -16, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 192]\n" },
+    { SuperoptShape::offset_mul, -16, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 224]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -16, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 288]\n" },
+    { SuperoptShape::offset_mul, -16, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 320]\n" },
+    { SuperoptShape::offset_mul, -16, 22, "    lea rbx, [rax * 2 - 352]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -16, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 384]\n" },
+    { SuperoptShape::offset_mul, -16, 26, "    lea rbx, [rax * 2 - 416]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -16, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 448]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -16, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 480]\n" },
+    { SuperoptShape::offset_mul, -15, 2, "    lea rax, [rax * 2 - 30]\n" },
+    { SuperoptShape::offset_mul, -15, 4, "    lea rax, [rax * 4 - 60]\n" },
+    { SuperoptShape::offset_mul, -15, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 90]\n" },
+    { SuperoptShape::offset_mul, -15, 8, "    lea rax, [rax * 8 - 120]\n" },
+    { SuperoptShape::offset_mul, -15, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 150]\n" },
+    { SuperoptShape::offset_mul, -15, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 180]\n" },
+    { SuperoptShape::offset_mul, -15, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 210]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -15, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 270]\n" },
+    { SuperoptShape::offset_mul, -15, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 300]\n" },
+    { SuperoptShape::offset_mul, -15, 22, "    lea rbx, [rax * 2 - 330]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -15, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 360]\n" },
+    { SuperoptShape::offset_mul, -15, 26, "    lea rbx, [rax * 2 - 390]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -15, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 420]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -15, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 450]\n" },
+    { SuperoptShape::offset_mul, -14, 2, "    lea rax, [rax * 2 - 28]\n" },
+    { SuperoptShape::offset_mul, -14, 4, "    lea rax, [rax * 4 - 56]\n" },
+    { SuperoptShape::offset_mul, -14, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 84]\n" },
+    { SuperoptShape::offset_mul, -14, 8, "    lea rax, [rax * 8 - 112]\n" },
+    { SuperoptShape::offset_mul, -14, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 140]\n" },
+    { SuperoptShape::offset_mul, -14, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 168]\n" },
+    { SuperoptShape::offset_mul, -14, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 196]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -14, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 252]\n" },
+    { SuperoptShape::offset_mul, -14, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 280]\n" },
+    { SuperoptShape::offset_mul, -14, 22, "    lea rbx, [rax * 2 - 308]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -14, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 336]\n" },
+    { SuperoptShape::offset_mul, -14, 26, "    lea rbx, [rax * 2 - 364]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -14, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 392]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -14, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 420]\n" },
+    { SuperoptShape::offset_mul, -13, 2, "    lea rax, [rax * 2 - 26]\n" },
+    { SuperoptShape::offset_mul, -13, 4, "    lea rax, [rax * 4 - 52]\n" },
+    { SuperoptShape::offset_mul, -13, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 78]\n" },
+    { SuperoptShape::offset_mul, -13, 8, "    lea rax, [rax * 8 - 104]\n" },
+    { SuperoptShape::offset_mul, -13, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 130]\n" },
+    { SuperoptShape::offset_mul, -13, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 156]\n" },
+    { SuperoptShape::offset_mul, -13, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 182]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -13, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 234]\n" },
+    { SuperoptShape::offset_mul, -13, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 260]\n" },
+    { SuperoptShape::offset_mul, -13, 22, "    lea rbx, [rax * 2 - 286]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -13, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 312]\n" },
+    { SuperoptShape::offset_mul, -13, 26, "    lea rbx, [rax * 2 - 338]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -13, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 364]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -13, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 390]\n" },
+    { SuperoptShape::offset_mul, -12, 2, "    lea rax, [rax * 2 - 24]\n" },
+    { SuperoptShape::offset_mul, -12, 4, "    lea rax, [rax * 4 - 48]\n" },
+    { SuperoptShape::offset_mul, -12, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 72]\n" },
+    { SuperoptShape::offset_mul, -12, 8, "    lea rax, [rax * 8 - 96]\n" },
+    { SuperoptShape::offset_mul, -12, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 120]\n" },
+    { SuperoptShape::offset_mul, -12, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 144]\n" },
+    { SuperoptShape::offset_mul, -12, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 168]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -12, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 216]\n" },
+    { SuperoptShape::offset_mul, -12, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 240]\n" },
+    { SuperoptShape::offset_mul, -12, 22, "    lea rbx, [rax * 2 - 264]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -12, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 288]\n" },
+    { SuperoptShape::offset_mul, -12, 26, "    lea rbx, [rax * 2 - 312]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -12, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 336]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -12, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 360]\n" },
+    { SuperoptShape::offset_mul, -11, 2, "    lea rax, [rax * 2 - 22]\n" },
+    { SuperoptShape::offset_mul, -11, 4, "    lea rax, [rax * 4 - 44]\n" },
+    { SuperoptShape::offset_mul, -11, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 66]\n" },
+    { SuperoptShape::offset_mul, -11, 8, "    lea rax, [rax * 8 - 88]\n" },
+    { SuperoptShape::offset_mul, -11, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 110]\n" },
+    { SuperoptShape::offset_mul, -11, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 132]\n" },
+    { SuperoptShape::offset_mul, -11, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 154]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -11, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 198]\n" },
+    { SuperoptShape::offset_mul, -11, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 220]\n" },
+    { SuperoptShape::offset_mul, -11, 22, "    lea rbx, [rax * 2 - 242]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -11, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 264]\n" },
+    { SuperoptShape::offset_mul, -11, 26, "    lea rbx, [rax * 2 - 286]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -11, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 308]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -11, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 330]\n" },
+    { SuperoptShape::offset_mul, -10, 2, "    lea rax, [rax * 2 - 20]\n" },
+    { SuperoptShape::offset_mul, -10, 4, "    lea rax, [rax * 4 - 40]\n" },
+    { SuperoptShape::offset_mul, -10, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 60]\n" },
+    { SuperoptShape::offset_mul, -10, 8, "    lea rax, [rax * 8 - 80]\n" },
+    { SuperoptShape::offset_mul, -10, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 100]\n" },
+    { SuperoptShape::offset_mul, -10, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 120]\n" },
+    { SuperoptShape::offset_mul, -10, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 140]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -10, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 180]\n" },
+    { SuperoptShape::offset_mul, -10, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 200]\n" },
+    { SuperoptShape::offset_mul, -10, 22, "    lea rbx, [rax * 2 - 220]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -10, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 240]\n" },
+    { SuperoptShape::offset_mul, -10, 26, "    lea rbx, [rax * 2 - 260]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -10, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 280]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -10, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 300]\n" },
+    { SuperoptShape::offset_mul, -9, 2, "    lea rax, [rax * 2 - 18]\n" },
+    { SuperoptShape::offset_mul, -9, 4, "    lea rax, [rax * 4 - 36]\n" },
+    { SuperoptShape::offset_mul, -9, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 54]\n" },
+    { SuperoptShape::offset_mul, -9, 8, "    lea rax, [rax * 8 - 72]\n" },
+    { SuperoptShape::offset_mul, -9, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 90]\n" },
+    { SuperoptShape::offset_mul, -9, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 108]\n" },
+    { SuperoptShape::offset_mul, -9, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 126]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -9, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 162]\n" },
+    { SuperoptShape::offset_mul, -9, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 180]\n" },
+    { SuperoptShape::offset_mul, -9, 22, "    lea rbx, [rax * 2 - 198]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -9, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 216]\n" },
+    { SuperoptShape::offset_mul, -9, 26, "    lea rbx, [rax * 2 - 234]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -9, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 252]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -9, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 270]\n" },
+    { SuperoptShape::offset_mul, -8, 2, "    lea rax, [rax * 2 - 16]\n" },
+    { SuperoptShape::offset_mul, -8, 4, "    lea rax, [rax * 4 - 32]\n" },
+    { SuperoptShape::offset_mul, -8, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 48]\n" },
+    { SuperoptShape::offset_mul, -8, 8, "    lea rax, [rax * 8 - 64]\n" },
+    { SuperoptShape::offset_mul, -8, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 80]\n" },
+    { SuperoptShape::offset_mul, -8, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 96]\n" },
+    { SuperoptShape::offset_mul, -8, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 112]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -8, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 144]\n" },
+    { SuperoptShape::offset_mul, -8, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 160]\n" },
+    { SuperoptShape::offset_mul, -8, 22, "    lea rbx, [rax * 2 - 176]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -8, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 192]\n" },
+    { SuperoptShape::offset_mul, -8, 26, "    lea rbx, [rax * 2 - 208]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -8, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 224]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -8, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 240]\n" },
+    { SuperoptShape::offset_mul, -7, 2, "    lea rax, [rax * 2 - 14]\n" },
+    { SuperoptShape::offset_mul, -7, 4, "    lea rax, [rax * 4 - 28]\n" },
+    { SuperoptShape::offset_mul, -7, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 42]\n" },
+    { SuperoptShape::offset_mul, -7, 8, "    lea rax, [rax * 8 - 56]\n" },
+    { SuperoptShape::offset_mul, -7, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 70]\n" },
+    { SuperoptShape::offset_mul, -7, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 84]\n" },
+    { SuperoptShape::offset_mul, -7, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 98]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -7, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 126]\n" },
+    { SuperoptShape::offset_mul, -7, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 140]\n" },
+    { SuperoptShape::offset_mul, -7, 22, "    lea rbx, [rax * 2 - 154]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -7, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 168]\n" },
+    { SuperoptShape::offset_mul, -7, 26, "    lea rbx, [rax * 2 - 182]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -7, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 196]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -7, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 210]\n" },
+    { SuperoptShape::offset_mul, -6, 2, "    lea rax, [rax * 2 - 12]\n" },
+    { SuperoptShape::offset_mul, -6, 4, "    lea rax, [rax * 4 - 24]\n" },
+    { SuperoptShape::offset_mul, -6, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 36]\n" },
+    { SuperoptShape::offset_mul, -6, 8, "    lea rax, [rax * 8 - 48]\n" },
+    { SuperoptShape::offset_mul, -6, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 60]\n" },
+    { SuperoptShape::offset_mul, -6, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 72]\n" },
+    { SuperoptShape::offset_mul, -6, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 84]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -6, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 108]\n" },
+    { SuperoptShape::offset_mul, -6, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 120]\n" },
+    { SuperoptShape::offset_mul, -6, 22, "    lea rbx, [rax * 2 - 132]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -6, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 144]\n" },
+    { SuperoptShape::offset_mul, -6, 26, "    lea rbx, [rax * 2 - 156]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -6, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 168]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -6, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 180]\n" },
+    { SuperoptShape::offset_mul, -5, 2, "    lea rax, [rax * 2 - 10]\n" },
+    { SuperoptShape::offset_mul, -5, 4, "    lea rax, [rax * 4 - 20]\n" },
+    { SuperoptShape::offset_mul, -5, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 30]\n" },
+    { SuperoptShape::offset_mul, -5, 8, "    lea rax, [rax * 8 - 40]\n" },
+    { SuperoptShape::offset_mul, -5, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 50]\n" },
+    { SuperoptShape::offset_mul, -5, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 60]\n" },
+    { SuperoptShape::offset_mul, -5, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 70]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -5, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 90]\n" },
+    { SuperoptShape::offset_mul, -5, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 100]\n" },
+    { SuperoptShape::offset_mul, -5, 22, "    lea rbx, [rax * 2 - 110]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -5, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 120]\n" },
+    { SuperoptShape::offset_mul, -5, 26, "    lea rbx, [rax * 2 - 130]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -5, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 140]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -5, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 150]\n" },
+    { SuperoptShape::offset_mul, -4, 2, "    lea rax, [rax * 2 - 8]\n" },
+    { SuperoptShape::offset_mul, -4, 4, "    lea rax, [rax * 4 - 16]\n" },
+    { SuperoptShape::offset_mul, -4, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 24]\n" },
+    { SuperoptShape::offset_mul, -4, 8, "    lea rax, [rax * 8 - 32]\n" },
+    { SuperoptShape::offset_mul, -4, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 40]\n" },
+    { SuperoptShape::offset_mul, -4, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 48]\n" },
+    { SuperoptShape::offset_mul, -4, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 56]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -4, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 72]\n" },
+    { SuperoptShape::offset_mul, -4, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 80]\n" },
+    { SuperoptShape::offset_mul, -4, 22, "    lea rbx, [rax * 2 - 88]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -4, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 96]\n" },
+    { SuperoptShape::offset_mul, -4, 26, "    lea rbx, [rax * 2 - 104]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -4, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 112]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -4, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 120]\n" },
+    { SuperoptShape::offset_mul, -3, 2, "    lea rax, [rax * 2 - 6]\n" },
+    { SuperoptShape::offset_mul, -3, 4, "    lea rax, [rax * 4 - 12]\n" },
+    { SuperoptShape::offset_mul, -3, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 18]\n" },
+    { SuperoptShape::offset_mul, -3, 8, "    lea rax, [rax * 8 - 24]\n" },
+    { SuperoptShape::offset_mul, -3, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 30]\n" },
+    { SuperoptShape::offset_mul, -3, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 36]\n" },
+    { SuperoptShape::offset_mul, -3, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 42]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -3, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 54]\n" },
+    { SuperoptShape::offset_mul, -3, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 60]\n" },
+    { SuperoptShape::offset_mul, -3, 22, "    lea rbx, [rax * 2 - 66]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -3, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 72]\n" },
+    { SuperoptShape::offset_mul, -3, 26, "    lea rbx, [rax * 2 - 78]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -3, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 84]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -3, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 90]\n" },
+    { SuperoptShape::offset_mul, -2, 2, "    lea rax, [rax * 2 - 4]\n" },
+    { SuperoptShape::offset_mul, -2, 4, "    lea rax, [rax * 4 - 8]\n" },
+    { SuperoptShape::offset_mul, -2, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 12]\n" },
+    { SuperoptShape::offset_mul, -2, 8, "    lea rax, [rax * 8 - 16]\n" },
+    { SuperoptShape::offset_mul, -2, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 20]\n" },
+    { SuperoptShape::offset_mul, -2, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 24]\n" },
+    { SuperoptShape::offset_mul, -2, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 28]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -2, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 36]\n" },
+    { SuperoptShape::offset_mul, -2, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 40]\n" },
+    { SuperoptShape::offset_mul, -2, 22, "    lea rbx, [rax * 2 - 44]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -2, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 48]\n" },
+    { SuperoptShape::offset_mul, -2, 26, "    lea rbx, [rax * 2 - 52]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -2, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 56]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -2, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 60]\n" },
+    { SuperoptShape::offset_mul, -1, 2, "    lea rax, [rax * 2 - 2]\n" },
+    { SuperoptShape::offset_mul, -1, 4, "    lea rax, [rax * 4 - 4]\n" },
+    { SuperoptShape::offset_mul, -1, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 - 6]\n" },
+    { SuperoptShape::offset_mul, -1, 8, "    lea rax, [rax * 8 - 8]\n" },
+    { SuperoptShape::offset_mul, -1, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 10]\n" },
+    { SuperoptShape::offset_mul, -1, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 - 12]\n" },
+    { SuperoptShape::offset_mul, -1, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 - 14]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -1, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 - 18]\n" },
+    { SuperoptShape::offset_mul, -1, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 - 20]\n" },
+    { SuperoptShape::offset_mul, -1, 22, "    lea rbx, [rax * 2 - 22]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, -1, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 - 24]\n" },
+    { SuperoptShape::offset_mul, -1, 26, "    lea rbx, [rax * 2 - 26]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, -1, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 - 28]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, -1, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 - 30]\n" },
+    { SuperoptShape::offset_mul, -1, 31, "    lea rbx, [rax + 31]\n    shl rax, 5\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 1, 2, "    lea rax, [rax * 2 + 2]\n" },
+    { SuperoptShape::offset_mul, 1, 4, "    lea rax, [rax * 4 + 4]\n" },
+    { SuperoptShape::offset_mul, 1, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 6]\n" },
+    { SuperoptShape::offset_mul, 1, 8, "    lea rax, [rax * 8 + 8]\n" },
+    { SuperoptShape::offset_mul, 1, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 10]\n" },
+    { SuperoptShape::offset_mul, 1, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 12]\n" },
+    { SuperoptShape::offset_mul, 1, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 14]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 1, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 18]\n" },
+    { SuperoptShape::offset_mul, 1, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 20]\n" },
+    { SuperoptShape::offset_mul, 1, 22, "    lea rbx, [rax * 2 + 22]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 1, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 24]\n" },
+    { SuperoptShape::offset_mul, 1, 26, "    lea rbx, [rax * 2 + 26]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 1, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 28]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 1, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 30]\n" },
+    { SuperoptShape::offset_mul, 2, 2, "    lea rax, [rax * 2 + 4]\n" },
+    { SuperoptShape::offset_mul, 2, 4, "    lea rax, [rax * 4 + 8]\n" },
+    { SuperoptShape::offset_mul, 2, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 12]\n" },
+    { SuperoptShape::offset_mul, 2, 8, "    lea rax, [rax * 8 + 16]\n" },
+    { SuperoptShape::offset_mul, 2, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 20]\n" },
+    { SuperoptShape::offset_mul, 2, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 24]\n" },
+    { SuperoptShape::offset_mul, 2, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 28]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 2, 17, "    lea rbx, [rax * 8 + 17]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::offset_mul, 2, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 36]\n" },
+    { SuperoptShape::offset_mul, 2, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 40]\n" },
+    { SuperoptShape::offset_mul, 2, 22, "    lea rbx, [rax * 2 + 44]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 2, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 48]\n" },
+    { SuperoptShape::offset_mul, 2, 26, "    lea rbx, [rax * 2 + 52]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 2, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 56]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 2, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 60]\n" },
+    { SuperoptShape::offset_mul, 3, 2, "    lea rax, [rax * 2 + 6]\n" },
+    { SuperoptShape::offset_mul, 3, 4, "    lea rax, [rax * 4 + 12]\n" },
+    { SuperoptShape::offset_mul, 3, 6, "    lea rax, [rax * 2 + 6]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::offset_mul, 3, 8, "    lea rax, [rax * 8 + 24]\n" },
+    { SuperoptShape::offset_mul, 3, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 30]\n" },
+    { SuperoptShape::offset_mul, 3, 12, "    lea rax, [rax * 4 + 12]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::offset_mul, 3, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 42]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 3, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 54]\n" },
+    { SuperoptShape::offset_mul, 3, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 60]\n" },
+    { SuperoptShape::offset_mul, 3, 22, "    lea rbx, [rax * 2 + 22]\n    lea rax, [rbx + rax * 8]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::offset_mul, 3, 24, "    lea rax, [rax * 8 + 24]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::offset_mul, 3, 26, "    lea rbx, [rax * 2 + 78]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 3, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 84]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 3, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 90]\n" },
+    { SuperoptShape::offset_mul, 4, 2, "    lea rax, [rax * 2 + 8]\n" },
+    { SuperoptShape::offset_mul, 4, 4, "    lea rax, [rax * 4 + 16]\n" },
+    { SuperoptShape::offset_mul, 4, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 24]\n" },
+    { SuperoptShape::offset_mul, 4, 8, "    lea rax, [rax * 8 + 32]\n" },
+    { SuperoptShape::offset_mul, 4, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 40]\n" },
+    { SuperoptShape::offset_mul, 4, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 48]\n" },
+    { SuperoptShape::offset_mul, 4, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 56]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 4, 17, "    lea rbx, [rax * 4 + 17]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::offset_mul, 4, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 72]\n" },
+    { SuperoptShape::offset_mul, 4, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 80]\n" },
+    { SuperoptShape::offset_mul, 4, 22, "    lea rbx, [rax * 2 + 88]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 4, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 96]\n" },
+    { SuperoptShape::offset_mul, 4, 26, "    lea rbx, [rax * 2 + 104]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 4, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 112]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 4, 29, "    lea rbx, [rax * 8 + 29]\n    sub rbx, rax\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::offset_mul, 4, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 120]\n" },
+    { SuperoptShape::offset_mul, 5, 2, "    lea rax, [rax * 2 + 10]\n" },
+    { SuperoptShape::offset_mul, 5, 4, "    lea rax, [rax * 4 + 20]\n" },
+    { SuperoptShape::offset_mul, 5, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 30]\n" },
+    { SuperoptShape::offset_mul, 5, 8, "    lea rax, [rax * 8 + 40]\n" },
+    { SuperoptShape::offset_mul, 5, 10, "    lea rax, [rax * 2 + 10]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 5, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 60]\n" },
+    { SuperoptShape::offset_mul, 5, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 70]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 5, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 90]\n" },
+    { SuperoptShape::offset_mul, 5, 20, "    lea rax, [rax * 4 + 20]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 5, 22, "    lea rbx, [rax * 2 + 110]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 5, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 120]\n" },
+    { SuperoptShape::offset_mul, 5, 26, "    lea rbx, [rax * 2 + 26]\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 5, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 140]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 5, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 30]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 6, 2, "    lea rax, [rax * 2 + 12]\n" },
+    { SuperoptShape::offset_mul, 6, 4, "    lea rax, [rax * 4 + 24]\n" },
+    { SuperoptShape::offset_mul, 6, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 36]\n" },
+    { SuperoptShape::offset_mul, 6, 8, "    lea rax, [rax * 8 + 48]\n" },
+    { SuperoptShape::offset_mul, 6, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 60]\n" },
+    { SuperoptShape::offset_mul, 6, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 72]\n" },
+    { SuperoptShape::offset_mul, 6, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 84]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 6, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 108]\n" },
+    { SuperoptShape::offset_mul, 6, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 120]\n" },
+    { SuperoptShape::offset_mul, 6, 22, "    lea rbx, [rax * 2 + 132]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 6, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 144]\n" },
+    { SuperoptShape::offset_mul, 6, 26, "    lea rbx, [rax * 2 + 156]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 6, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 168]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 6, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 180]\n" },
+    { SuperoptShape::offset_mul, 7, 2, "    lea rax, [rax * 2 + 14]\n" },
+    { SuperoptShape::offset_mul, 7, 4, "    lea rax, [rax * 4 + 28]\n" },
+    { SuperoptShape::offset_mul, 7, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 42]\n" },
+    { SuperoptShape::offset_mul, 7, 8, "    lea rax, [rax * 8 + 56]\n" },
+    { SuperoptShape::offset_mul, 7, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 70]\n" },
+    { SuperoptShape::offset_mul, 7, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 84]\n" },
+    { SuperoptShape::offset_mul, 7, 14, "    lea rax, [rax * 2 + 14]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::offset_mul, 7, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 126]\n" },
+    { SuperoptShape::offset_mul, 7, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 140]\n" },
+    { SuperoptShape::offset_mul, 7, 22, "    lea rbx, [rax * 2 + 154]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 7, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 168]\n" },
+    { SuperoptShape::offset_mul, 7, 26, "    lea rbx, [rax * 2 + 182]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 7, 28, "    lea rax, [rax * 4 + 28]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::offset_mul, 7, 29, "    lea rbx, [rax * 4 + 29]\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::offset_mul, 7, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 210]\n" },
+    { SuperoptShape::offset_mul, 8, 2, "    lea rax, [rax * 2 + 16]\n" },
+    { SuperoptShape::offset_mul, 8, 4, "    lea rax, [rax * 4 + 32]\n" },
+    { SuperoptShape::offset_mul, 8, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 48]\n" },
+    { SuperoptShape::offset_mul, 8, 8, "    lea rax, [rax * 8 + 64]\n" },
+    { SuperoptShape::offset_mul, 8, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 80]\n" },
+    { SuperoptShape::offset_mul, 8, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 96]\n" },
+    { SuperoptShape::offset_mul, 8, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 112]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 8, 17, "    lea rbx, [rax * 2 + 17]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::offset_mul, 8, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 144]\n" },
+    { SuperoptShape::offset_mul, 8, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 160]\n" },
+    { SuperoptShape::offset_mul, 8, 22, "    lea rbx, [rax * 2 + 176]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 8, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 192]\n" },
+    { SuperoptShape::offset_mul, 8, 26, "    lea rbx, [rax * 2 + 208]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 8, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 224]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 8, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 240]\n" },
+    { SuperoptShape::offset_mul, 9, 2, "    lea rax, [rax * 2 + 18]\n" },
+    { SuperoptShape::offset_mul, 9, 4, "    lea rax, [rax * 4 + 36]\n" },
+    { SuperoptShape::offset_mul, 9, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 54]\n" },
+    { SuperoptShape::offset_mul, 9, 8, "    lea rax, [rax * 8 + 72]\n" },
+    { SuperoptShape::offset_mul, 9, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 90]\n" },
+    { SuperoptShape::offset_mul, 9, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 108]\n" },
+    { SuperoptShape::offset_mul, 9, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 126]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 9, 18, "    lea rax, [rax * 2 + 18]\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 9, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 180]\n" },
+    { SuperoptShape::offset_mul, 9, 22, "    lea rbx, [rax * 2 + 22]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 9, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 216]\n" },
+    { SuperoptShape::offset_mul, 9, 26, "    lea rbx, [rax * 2 + 26]\n    add rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 9, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 252]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 9, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 270]\n" },
+    { SuperoptShape::offset_mul, 10, 2, "    lea rax, [rax * 2 + 20]\n" },
+    { SuperoptShape::offset_mul, 10, 4, "    lea rax, [rax * 4 + 40]\n" },
+    { SuperoptShape::offset_mul, 10, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 60]\n" },
+    { SuperoptShape::offset_mul, 10, 8, "    lea rax, [rax * 8 + 80]\n" },
+    { SuperoptShape::offset_mul, 10, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 100]\n" },
+    { SuperoptShape::offset_mul, 10, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 120]\n" },
+    { SuperoptShape::offset_mul, 10, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 140]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 10, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 180]\n" },
+    { SuperoptShape::offset_mul, 10, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 200]\n" },
+    { SuperoptShape::offset_mul, 10, 22, "    lea rbx, [rax * 2 + 220]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 10, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 240]\n" },
+    { SuperoptShape::offset_mul, 10, 26, "    lea rbx, [rax * 2 + 260]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 10, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 280]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 10, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 300]\n" },
+    { SuperoptShape::offset_mul, 11, 2, "    lea rax, [rax * 2 + 22]\n" },
+    { SuperoptShape::offset_mul, 11, 4, "    lea rax, [rax * 4 + 44]\n" },
+    { SuperoptShape::offset_mul, 11, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 66]\n" },
+    { SuperoptShape::offset_mul, 11, 8, "    lea rax, [rax * 8 + 88]\n" },
+    { SuperoptShape::offset_mul, 11, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 110]\n" },
+    { SuperoptShape::offset_mul, 11, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 132]\n" },
+    { SuperoptShape::offset_mul, 11, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 154]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 11, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 198]\n" },
+    { SuperoptShape::offset_mul, 11, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 220]\n" },
+    { SuperoptShape::offset_mul, 11, 22, "    lea rax, [rax * 2 + 22]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 11, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 264]\n" },
+    { SuperoptShape::offset_mul, 11, 26, "    lea rbx, [rax * 2 + 286]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 11, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 308]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 11, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 330]\n" },
+    { SuperoptShape::offset_mul, 12, 2, "    lea rax, [rax * 2 + 24]\n" },
+    { SuperoptShape::offset_mul, 12, 4, "    lea rax, [rax * 4 + 48]\n" },
+    { SuperoptShape::offset_mul, 12, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 72]\n" },
+    { SuperoptShape::offset_mul, 12, 8, "    lea rax, [rax * 8 + 96]\n" },
+    { SuperoptShape::offset_mul, 12, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 120]\n" },
+    { SuperoptShape::offset_mul, 12, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 144]\n" },
+    { SuperoptShape::offset_mul, 12, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 168]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 12, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 216]\n" },
+    { SuperoptShape::offset_mul, 12, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 240]\n" },
+    { SuperoptShape::offset_mul, 12, 22, "    lea rbx, [rax * 2 + 264]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 12, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 288]\n" },
+    { SuperoptShape::offset_mul, 12, 26, "    lea rbx, [rax * 2 + 312]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 12, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 336]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 12, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 360]\n" },
+    { SuperoptShape::offset_mul, 13, 2, "    lea rax, [rax * 2 + 26]\n" },
+    { SuperoptShape::offset_mul, 13, 4, "    lea rax, [rax * 4 + 52]\n" },
+    { SuperoptShape::offset_mul, 13, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 78]\n" },
+    { SuperoptShape::offset_mul, 13, 8, "    lea rax, [rax * 8 + 104]\n" },
+    { SuperoptShape::offset_mul, 13, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 130]\n" },
+    { SuperoptShape::offset_mul, 13, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 156]\n" },
+    { SuperoptShape::offset_mul, 13, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 182]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 13, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 234]\n" },
+    { SuperoptShape::offset_mul, 13, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 260]\n" },
+    { SuperoptShape::offset_mul, 13, 22, "    lea rbx, [rax * 2 + 286]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 13, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 312]\n" },
+    { SuperoptShape::offset_mul, 13, 26, "    lea rax, [rax * 2 + 26]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::offset_mul, 13, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 364]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 13, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 390]\n" },
+    { SuperoptShape::offset_mul, 14, 2, "    lea rax, [rax * 2 + 28]\n" },
+    { SuperoptShape::offset_mul, 14, 4, "    lea rax, [rax * 4 + 56]\n" },
+    { SuperoptShape::offset_mul, 14, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 84]\n" },
+    { SuperoptShape::offset_mul, 14, 8, "    lea rax, [rax * 8 + 112]\n" },
+    { SuperoptShape::offset_mul, 14, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 140]\n" },
+    { SuperoptShape::offset_mul, 14, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 168]\n" },
+    { SuperoptShape::offset_mul, 14, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 196]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 14, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 252]\n" },
+    { SuperoptShape::offset_mul, 14, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 280]\n" },
+    { SuperoptShape::offset_mul, 14, 22, "    lea rbx, [rax * 2 + 308]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 14, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 336]\n" },
+    { SuperoptShape::offset_mul, 14, 26, "    lea rbx, [rax * 2 + 364]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 14, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 392]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 14, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 420]\n" },
+    { SuperoptShape::offset_mul, 15, 2, "    lea rax, [rax * 2 + 30]\n" },
+    { SuperoptShape::offset_mul, 15, 4, "    lea rax, [rax * 4 + 60]\n" },
+    { SuperoptShape::offset_mul, 15, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 90]\n" },
+    { SuperoptShape::offset_mul, 15, 8, "    lea rax, [rax * 8 + 120]\n" },
+    { SuperoptShape::offset_mul, 15, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 150]\n" },
+    { SuperoptShape::offset_mul, 15, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 180]\n" },
+    { SuperoptShape::offset_mul, 15, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 210]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 15, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 270]\n" },
+    { SuperoptShape::offset_mul, 15, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 300]\n" },
+    { SuperoptShape::offset_mul, 15, 22, "    lea rbx, [rax * 2 + 330]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 15, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 360]\n" },
+    { SuperoptShape::offset_mul, 15, 26, "    lea rbx, [rax * 2 + 390]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 15, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 420]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 15, 30, "    lea rax, [rax * 2 + 30]\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 16, 2, "    lea rax, [rax * 2 + 32]\n" },
+    { SuperoptShape::offset_mul, 16, 4, "    lea rax, [rax * 4 + 64]\n" },
+    { SuperoptShape::offset_mul, 16, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 2 + 96]\n" },
+    { SuperoptShape::offset_mul, 16, 8, "    lea rax, [rax * 8 + 128]\n" },
+    { SuperoptShape::offset_mul, 16, 10, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 160]\n" },
+    { SuperoptShape::offset_mul, 16, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 4 + 192]\n" },
+    { SuperoptShape::offset_mul, 16, 14, "    lea rbx, [rax * 2]\n    lea rax, [rbx * 8 + 224]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 16, 18, "    lea rax, [rax + rax * 8]\n    lea rax, [rax * 2 + 288]\n" },
+    { SuperoptShape::offset_mul, 16, 20, "    lea rax, [rax + rax * 4]\n    lea rax, [rax * 4 + 320]\n" },
+    { SuperoptShape::offset_mul, 16, 22, "    lea rbx, [rax * 2 + 352]\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::offset_mul, 16, 24, "    lea rax, [rax + rax * 2]\n    lea rax, [rax * 8 + 384]\n" },
+    { SuperoptShape::offset_mul, 16, 26, "    lea rbx, [rax * 2 + 416]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::offset_mul, 16, 28, "    lea rbx, [rax * 4]\n    lea rax, [rbx * 8 + 448]\n    sub rax, rbx\n" },
+    { SuperoptShape::offset_mul, 16, 30, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax * 2 + 480]\n" },
+    { SuperoptShape::lin_comb, 1, -14, "    lea rax, [rax + rbx * 2]\n    shl rbx, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 1, 2, "    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 1, 4, "    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 1, 6, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 1, 7, "    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 1, 8, "    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 1, 10, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 1, 12, "    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 1, 14, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 2, -15, "    lea rax, [rbx + rax * 2]\n    shl rbx, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 2, -10, "    lea rbx, [rbx + rbx * 4]\n    sub rax, rbx\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 2, -7, "    lea rax, [rbx + rax * 2]\n    shl rbx, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 2, -6, "    lea rbx, [rbx + rbx * 2]\n    sub rax, rbx\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 2, -2, "    sub rax, rbx\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 2, 1, "    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 2, "    add rax, rax\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 3, "    add rax, rbx\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 4, "    add rax, rax\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 2, 5, "    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 6, "    add rax, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 2, 7, "    add rax, rax\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 2, 8, "    add rax, rax\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 2, 9, "    lea rax, [rax + rbx * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 10, "    add rax, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 2, 11, "    add rax, rbx\n    lea rax, [rax + rbx * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 12, "    add rax, rax\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 2, 13, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 14, "    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 2, 15, "    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 2, 16, "    lea rax, [rax + rbx * 8]\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 3, -15, "    lea rbx, [rbx + rbx * 4]\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, -12, "    shl rbx, 2\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, -6, "    sub rax, rbx\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, -3, "    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 2, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 3, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 4, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 3, 6, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 7, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 3, 8, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 3, 10, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 3, 11, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 3, 12, "    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 13, "    sub rax, rbx\n    lea rbx, [rax + rbx * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 14, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 3, 15, "    add rax, rbx\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 3, 16, "    lea rbx, [rax + rbx * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 4, -15, "    lea rax, [rbx + rax * 4]\n    shl rbx, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 4, -12, "    shl rbx, 2\n    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, -7, "    sub rax, rbx\n    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, -6, "    add rbx, rbx\n    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, -4, "    sub rax, rbx\n    shl rax, 2\n" },
+    { SuperoptShape::lin_comb, 4, -3, "    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 1, "    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 2, "    shl rax, 2\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 4, 3, "    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 4, 4, "    add rax, rbx\n    shl rax, 2\n" },
+    { SuperoptShape::lin_comb, 4, 5, "    add rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 6, "    add rax, rbx\n    shl rax, 2\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 4, 7, "    add rax, rbx\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 4, 8, "    shl rax, 2\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 4, 9, "    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 10, "    shl rax, 2\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 4, 11, "    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 4, 12, "    add rax, rbx\n    shl rax, 2\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 4, 13, "    add rax, rbx\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 14, "    imul rbx, rbx, 14\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 4, 15, "    lea rax, [rax + rbx * 4]\n    shl rax, 2\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 4, 16, "    lea rax, [rax + rbx * 4]\n    shl rax, 2\n" },
+    { SuperoptShape::lin_comb, 5, -15, "    lea rbx, [rbx + rbx * 2]\n    sub rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, -10, "    sub rax, rbx\n    sub rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, -6, "    sub rax, rbx\n    lea rax, [rax + rax * 4]\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 5, -5, "    sub rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 2, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 5, 4, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 5, "    add rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 6, "    add rax, rbx\n    lea rax, [rax + rax * 4]\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 5, 7, "    add rax, rbx\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 5, 8, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 5, 10, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 11, "    sub rax, rbx\n    lea rbx, [rax + rbx * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 12, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 5, 13, "    add rax, rbx\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 5, 14, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 15, "    add rax, rbx\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 5, 16, "    lea rbx, [rax + rbx * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 6, -12, "    sub rax, rbx\n    sub rax, rbx\n    imul rax, rax, 6\n" },
+    { SuperoptShape::lin_comb, 6, -7, "    sub rax, rbx\n    imul rax, rax, 6\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 6, -6, "    sub rax, rbx\n    add rax, rax\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, -5, "    sub rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, -3, "    add rax, rax\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, -2, "    lea rax, [rax + rax * 2]\n    sub rax, rbx\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 6, 1, "    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 2, "    add rax, rax\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 3, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 4, "    add rax, rax\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 6, 5, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 6, "    add rax, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 7, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 8, "    add rax, rax\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 6, 9, "    add rax, rbx\n    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 10, "    lea rbx, [rax + rbx * 2]\n    add rax, rbx\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 6, 11, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 6, 12, "    add rax, rax\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 13, "    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 14, "    add rax, rbx\n    imul rax, rax, 6\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 6, 15, "    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 6, 16, "    add rax, rax\n    lea rbx, [rax + rbx * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 7, -14, "    sub rax, rbx\n    sub rax, rbx\n    imul rax, rax, 7\n" },
+    { SuperoptShape::lin_comb, 7, -8, "    lea rbx, [rax + rbx * 8]\n    shl rax, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 7, -7, "    sub rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 7, -6, "    sub rax, rbx\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 7, -4, "    lea rbx, [rax + rbx * 4]\n    shl rax, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 7, -3, "    sub rbx, rax\n    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 7, -2, "    lea rbx, [rax + rbx * 2]\n    shl rax, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 7, 1, "    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 7, 2, "    add rbx, rax\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 3, "    add rbx, rax\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 4, "    add rbx, rax\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 7, 5, "    add rbx, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 6, "    add rbx, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 7, 7, "    add rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 8, "    add rax, rbx\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 7, 9, "    sub rbx, rax\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 7, 10, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 11, "    add rax, rbx\n    imul rax, rax, 7\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 7, 12, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 7, 13, "    lea rax, [rax + rbx * 2]\n    imul rax, rax, 7\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 7, 14, "    lea rax, [rax + rbx * 2]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 7, 15, "    lea rax, [rax + rbx * 2]\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 7, 16, "    shl rbx, 4\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, -15, "    sub rax, rbx\n    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, -14, "    add rbx, rbx\n    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, -8, "    sub rax, rbx\n    shl rax, 3\n" },
+    { SuperoptShape::lin_comb, 8, -7, "    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, -6, "    sub rax, rbx\n    shl rax, 3\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 8, 1, "    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, 2, "    shl rax, 3\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 8, 3, "    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 8, 4, "    shl rax, 3\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 8, 5, "    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 8, 6, "    shl rax, 3\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 8, 7, "    add rax, rbx\n    shl rax, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 8, 8, "    add rax, rbx\n    shl rax, 3\n" },
+    { SuperoptShape::lin_comb, 8, 9, "    add rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 8, 10, "    add rax, rbx\n    shl rax, 3\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 8, 11, "    add rax, rbx\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 8, 12, "    add rax, rbx\n    shl rax, 3\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 8, 13, "    add rax, rbx\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 8, 14, "    lea rbx, [rax + rbx * 2]\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 8, 15, "    lea rax, [rax + rbx * 2]\n    shl rax, 3\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 8, 16, "    lea rax, [rax + rbx * 2]\n    shl rax, 3\n" },
+    { SuperoptShape::lin_comb, 9, -10, "    sub rax, rbx\n    lea rax, [rax + rax * 8]\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 9, -9, "    sub rax, rbx\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 9, -7, "    sub rax, rbx\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 9, 2, "    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 9, 4, "    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 9, 6, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 9, 7, "    sub rax, rbx\n    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 9, 8, "    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 9, 9, "    add rax, rbx\n    lea rax, [rax + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 9, 10, "    add rax, rbx\n    lea rax, [rax + rax * 8]\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 9, 11, "    add rax, rbx\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 9, 12, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 9, 13, "    add rax, rbx\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 9, 16, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 10, -11, "    sub rax, rbx\n    imul rax, rax, 10\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 10, -10, "    sub rax, rbx\n    add rax, rax\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 10, -9, "    sub rax, rbx\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 10, -6, "    sub rax, rbx\n    imul rax, rax, 10\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 10, -5, "    add rax, rax\n    sub rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 10, -2, "    lea rax, [rax + rax * 4]\n    sub rax, rbx\n    add rax, rax\n" },
+    { SuperoptShape::lin_comb, 10, 1, "    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 2, "    add rax, rax\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 3, "    lea rax, [rax + rax * 4]\n    add rax, rbx\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 4, "    add rax, rax\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 10, 5, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 10, 6, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 4]\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 10, 7, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 8, "    add rax, rax\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 10, 9, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 10, "    add rax, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 10, 11, "    add rax, rbx\n    lea rax, [rax + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 10, 12, "    imul rax, rax, 10\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 10, 13, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 10, 14, "    add rax, rbx\n    imul rax, rax, 10\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 10, 15, "    add rax, rbx\n    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 10, 16, "    add rax, rax\n    lea rbx, [rax + rbx * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 11, -12, "    sub rax, rbx\n    imul rax, rax, 11\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 11, -11, "    sub rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 11, -10, "    sub rax, rbx\n    imul rax, rax, 11\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 11, -7, "    sub rax, rbx\n    imul rax, rax, 11\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 11, 2, "    add rbx, rax\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 3, "    add rbx, rax\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 4, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 5, "    sub rbx, rax\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 11, 6, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 7, "    imul rax, rax, 11\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 11, 8, "    add rbx, rax\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 11, 9, "    add rbx, rax\n    lea rax, [rax + rbx * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 10, "    add rbx, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 11, 11, "    add rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 11, 12, "    lea rbx, [rax + rbx * 4]\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 13, "    add rax, rbx\n    imul rax, rax, 11\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 11, 15, "    add rax, rbx\n    imul rax, rax, 11\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 11, 16, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 12, -13, "    sub rax, rbx\n    imul rax, rax, 12\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 12, -12, "    sub rax, rbx\n    shl rax, 2\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, -11, "    sub rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 12, -10, "    sub rax, rbx\n    imul rax, rax, 12\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 12, -9, "    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, -6, "    add rax, rax\n    sub rax, rbx\n    imul rax, rax, 6\n" },
+    { SuperoptShape::lin_comb, 12, -4, "    lea rax, [rax + rax * 2]\n    sub rax, rbx\n    shl rax, 2\n" },
+    { SuperoptShape::lin_comb, 12, -3, "    shl rax, 2\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 1, "    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 12, 2, "    shl rax, 2\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 3, "    lea rax, [rbx + rax * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 4, "    shl rax, 2\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 12, 5, "    lea rax, [rax + rax * 2]\n    add rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 12, 6, "    shl rax, 2\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 7, "    lea rax, [rbx + rax * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 8, "    shl rax, 2\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 12, 9, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 12, 10, "    imul rax, rax, 12\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 12, 11, "    lea rax, [rbx + rax * 4]\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 12, 12, "    add rax, rbx\n    shl rax, 2\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 13, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 12, 14, "    add rax, rbx\n    imul rax, rax, 12\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 15, "    add rax, rbx\n    lea rax, [rbx + rax * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 12, 16, "    shl rax, 2\n    lea rbx, [rax + rbx * 8]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 13, -14, "    sub rax, rbx\n    imul rax, rax, 13\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 13, -13, "    sub rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 13, -12, "    sub rax, rbx\n    imul rax, rax, 13\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 13, -11, "    sub rax, rbx\n    imul rax, rax, 13\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 13, 2, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 3, "    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 13, 4, "    add rbx, rax\n    lea rax, [rax + rax * 8]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 5, "    add rbx, rax\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 6, "    lea rbx, [rbx + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 7, "    imul rax, rax, 13\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 13, 8, "    add rbx, rax\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 13, 9, "    add rbx, rax\n    lea rax, [rax + rbx * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 10, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 11, "    add rbx, rax\n    imul rbx, rbx, 11\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 13, 12, "    add rbx, rax\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 13, 13, "    add rax, rbx\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 13, 14, "    add rax, rbx\n    imul rax, rax, 13\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 13, 15, "    add rax, rbx\n    imul rax, rax, 13\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 13, 16, "    lea rbx, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 14, -15, "    sub rax, rbx\n    imul rax, rax, 14\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 14, -14, "    sub rax, rbx\n    imul rax, rax, 14\n" },
+    { SuperoptShape::lin_comb, 14, -13, "    sub rax, rbx\n    imul rax, rax, 14\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 14, -12, "    sub rax, rbx\n    imul rax, rax, 14\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 14, -10, "    sub rax, rbx\n    imul rax, rax, 14\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 14, -7, "    add rax, rax\n    sub rax, rbx\n    imul rax, rax, 7\n" },
+    { SuperoptShape::lin_comb, 14, -6, "    sub rax, rbx\n    imul rax, rax, 14\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 14, -1, "    lea rbx, [rbx + rax * 2]\n    shl rax, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 14, 1, "    add rax, rax\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 14, 2, "    sub rbx, rax\n    shl rax, 4\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 14, 3, "    lea rbx, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 14, 4, "    imul rax, rax, 14\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 14, 5, "    lea rbx, [rbx + rax * 2]\n    add rax, rbx\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 14, 6, "    imul rax, rax, 14\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 14, 7, "    lea rax, [rbx + rax * 2]\n    lea rbx, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 14, 8, "    lea rax, [rbx + rax * 2]\n    sub rbx, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 14, 10, "    imul rax, rax, 14\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 14, 12, "    imul rax, rax, 14\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 14, 13, "    add rax, rbx\n    imul rax, rax, 14\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 14, 14, "    add rax, rbx\n    imul rax, rax, 14\n" },
+    { SuperoptShape::lin_comb, 14, 15, "    add rax, rbx\n    imul rax, rax, 14\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, -15, "    sub rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, -14, "    sub rax, rbx\n    imul rax, rax, 15\n    add rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, -13, "    sub rax, rbx\n    imul rax, rax, 15\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 15, -11, "    sub rax, rbx\n    imul rax, rax, 15\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 15, -8, "    lea rbx, [rax + rbx * 8]\n    shl rax, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, -7, "    sub rbx, rax\n    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 15, -5, "    lea rax, [rax + rax * 2]\n    sub rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, -4, "    lea rbx, [rax + rbx * 4]\n    shl rax, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, -3, "    lea rax, [rax + rax * 4]\n    sub rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 15, -2, "    lea rbx, [rax + rbx * 2]\n    shl rax, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, 2, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 15, 3, "    lea rax, [rax + rax * 4]\n    add rax, rbx\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 15, 4, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 15, 5, "    lea rax, [rax + rax * 2]\n    add rax, rbx\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, 6, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 15, 7, "    lea rbx, [rbx + rax * 2]\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 15, 8, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 15, 10, "    lea rax, [rax + rax * 2]\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, 11, "    add rbx, rax\n    imul rbx, rbx, 11\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, 12, "    lea rax, [rax + rax * 4]\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 15, 13, "    add rbx, rax\n    imul rbx, rbx, 13\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 15, 14, "    add rax, rbx\n    imul rax, rax, 15\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 15, 15, "    add rax, rbx\n    lea rax, [rax + rax * 2]\n    lea rax, [rax + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 15, 16, "    lea rax, [rax + rax * 2]\n    lea rbx, [rax + rbx * 4]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 16, -16, "    sub rax, rbx\n    shl rax, 4\n" },
+    { SuperoptShape::lin_comb, 16, -15, "    sub rax, rbx\n    add rax, rax\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 16, -14, "    sub rax, rbx\n    shl rax, 4\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 16, -13, "    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 16, -12, "    sub rax, rbx\n    shl rax, 4\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 16, -11, "    sub rax, rbx\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 16, -7, "    add rax, rax\n    sub rax, rbx\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 2, "    shl rax, 4\n    lea rax, [rax + rbx * 2]\n" },
+    { SuperoptShape::lin_comb, 16, 3, "    lea rax, [rbx + rax * 8]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 16, 4, "    shl rax, 4\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 16, 5, "    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 16, 6, "    shl rax, 4\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 4]\n" },
+    { SuperoptShape::lin_comb, 16, 7, "    shl rax, 4\n    sub rax, rbx\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 8, "    shl rax, 4\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 9, "    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 10, "    shl rax, 4\n    lea rax, [rax + rbx * 2]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 11, "    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n    lea rax, [rbx + rax * 2]\n" },
+    { SuperoptShape::lin_comb, 16, 12, "    shl rax, 4\n    lea rax, [rax + rbx * 4]\n    lea rax, [rax + rbx * 8]\n" },
+    { SuperoptShape::lin_comb, 16, 13, "    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 2]\n    lea rax, [rbx + rax * 4]\n" },
+    { SuperoptShape::lin_comb, 16, 15, "    add rax, rbx\n    shl rax, 4\n    sub rax, rbx\n" },
+    { SuperoptShape::lin_comb, 16, 16, "    add rax, rbx\n    shl rax, 4\n" },
+} };
+
+// The entry for `shape` with these constants, if the search found one.
+inline const SuperoptEntry* superopt_lookup(const SuperoptShape shape, const int64_t k1, const int64_t k2)
+{
+    const auto key = [](const SuperoptEntry& e) { return std::tuple { e.shape, e.k1, e.k2 }; };
+    const auto it = std::ranges::lower_bound(superopt_table, std::tuple { shape, k1, k2 }, {}, key);
+    if (it == superopt_table.end() || key(*it) != std::tuple { shape, k1, k2 }) {
+        return nullptr;
+    }
+    return &*it;
+}
@@ -1,8 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <exception>
+#include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+// Thrown once a compile error has been reported on std::cerr. The command
+// line driver turns it into a failing exit status; the compile server turns
+// it into a failed request and stays up.
+struct CompileError : std::exception {
+    [[nodiscard]] const char* what() const noexcept override
+    {
+        return "compile error";
+    }
+};
+
+[[noreturn]] inline void compile_error()
+{
+    throw CompileError {};
+}
+
 enum class TokenType {
     exit,
     int_lit,
@@ -12,15 +36,19 @@ enum class TokenType {
     ident,
     let,
     eq,
+    eq_eq,
     plus,
     star,
     minus,
     fslash,
     open_curly,
     close_curly,
+    open_bracket,
+    close_bracket,
     if_,
     elif,
     else_,
+    print,
 };
 
 inline std::string to_string(const TokenType type)
@@ -42,6 +70,8 @@ inline std::string to_string(const TokenType type)
         return "`let`";
     case TokenType::eq:
         return "`=`";
+    case TokenType::eq_eq:
+        return "`==`";
     case TokenType::plus:
         return "`+`";
     case TokenType::star:
@@ -54,12 +84,18 @@ inline std::string to_string(const TokenType type)
         return "`{`";
     case TokenType::close_curly:
         return "`}`";
+    case TokenType::open_bracket:
+        return "`[`";
+    case TokenType::close_bracket:
+        return "`]`";
     case TokenType::if_:
         return "`if`";
     case TokenType::elif:
         return "`elif`";
     case TokenType::else_:
         return "`else`";
+    case TokenType::print:
+        return "`print`";
     }
     assert(false);
 }
@@ -67,12 +103,14 @@ inline std::string to_string(const TokenType type)
 inline std::optional<int> bin_prec(const TokenType type)
 {
     switch (type) {
+    case TokenType::eq_eq:
+        return 0;
     case TokenType::minus:
     case TokenType::plus:
-        return 0;
+        return 1;
     case TokenType::fslash:
     case TokenType::star:
-        return 1;
+        return 2;
     default:
         return {};
     }
@@ -84,19 +122,30 @@ struct Token {
     std::optional<std::string> value {};
 };
 
-class Tokenizer {
+// Lexes one slice of the source. A slice starts at the beginning of a line
+// and may start inside a block comment opened by an earlier slice.
+class ChunkLexer {
 public:
-    explicit Tokenizer(std::string src)
-        : m_src(std::move(src))
+    ChunkLexer(const std::string_view src, const int first_line, const bool in_block_comment)
+        : m_src(src)
+        , m_first_line(first_line)
+        , m_in_block_comment(in_block_comment)
     {
     }
 
-    std::vector<Token> tokenize()
+    // Appends the slice's tokens to `tokens`. Returns false on an invalid token.
+    // If `offsets` is given, it gets the byte offset in the slice of each token.
+    bool lex(std::vector<Token>& tokens, std::vector<size_t>* offsets = nullptr)
     {
-        std::vector<Token> tokens;
+        if (m_in_block_comment) {
+            int line_count = m_first_line;
+            skip_block_comment(line_count);
+            m_first_line = line_count;
+        }
         std::string buf;
-        int line_count = 1;
+        int line_count = m_first_line;
         while (peek().has_value()) {
+            const size_t start = m_index;
             if (std::isalpha(peek().value())) {
                 buf.push_back(consume());
                 while (peek().has_value() && std::isalnum(peek().value())) {
@@ -122,6 +171,10 @@ public:
                     tokens.push_back({ TokenType::else_, line_count });
                     buf.clear();
                 }
+                else if (buf == "print") {
+                    tokens.push_back({ TokenType::print, line_count });
+                    buf.clear();
+                }
                 else {
                     tokens.push_back({ TokenType::ident, line_count, buf });
                     buf.clear();
@@ -145,18 +198,7 @@ public:
             else if (peek().value() == '/' && peek(1).has_value() && peek(1).value() == '*') {
                 consume();
                 consume();
-                while (peek().has_value()) {
-                    if (peek().value() == '*' && peek(1).has_value() && peek(1).value() == '/') {
-                        break;
-                    }
-                    consume();
-                }
-                if (peek().has_value()) {
-                    consume();
-                }
-                if (peek().has_value()) {
-                    consume();
-                }
+                skip_block_comment(line_count);
             }
             else if (peek().value() == '(') {
                 consume();
@@ -170,6 +212,11 @@ public:
                 consume();
                 tokens.push_back({ TokenType::semi, line_count });
             }
+            else if (peek().value() == '=' && peek(1).has_value() && peek(1).value() == '=') {
+                consume();
+                consume();
+                tokens.push_back({ TokenType::eq_eq, line_count });
+            }
             else if (peek().value() == '=') {
                 consume();
                 tokens.push_back({ TokenType::eq, line_count });
@@ -198,6 +245,14 @@ public:
                 consume();
                 tokens.push_back({ TokenType::close_curly, line_count });
             }
+            else if (peek().value() == '[') {
+                consume();
+                tokens.push_back({ TokenType::open_bracket, line_count });
+            }
+            else if (peek().value() == ']') {
+                consume();
+                tokens.push_back({ TokenType::close_bracket, line_count });
+            }
             else if (peek().value() == '\n') {
                 consume();
                 line_count++;
@@ -206,28 +261,186 @@ public:
                 consume();
             }
             else {
-                std::cerr << "Invalid token" << std::endl;
-                exit(EXIT_FAILURE);
+                return false;
+            }
+            if (offsets != nullptr) {
+                offsets->resize(tokens.size(), start);
             }
         }
-        m_index = 0;
-        return tokens;
+        return true;
+    }
+
+    // Whether a slice entered in the given comment state ends inside a block
+    // comment. Mirrors how lex() recognises comments without producing tokens.
+    static bool ends_in_block_comment(const std::string_view src, bool in_block_comment)
+    {
+        size_t i = 0;
+        while (i < src.size()) {
+            if (in_block_comment) {
+                const size_t close = src.find("*/", i);
+                if (close == std::string_view::npos) {
+                    return true;
+                }
+                i = close + 2;
+                in_block_comment = false;
+            }
+            else {
+                const size_t slash = src.find('/', i);
+                if (slash == std::string_view::npos || slash + 1 >= src.size()) {
+                    return false;
+                }
+                if (src[slash + 1] == '/') {
+                    const size_t newline = src.find('\n', slash);
+                    if (newline == std::string_view::npos) {
+                        return false;
+                    }
+                    i = newline;
+                }
+                else if (src[slash + 1] == '*') {
+                    i = slash + 2;
+                    in_block_comment = true;
+                }
+                else {
+                    i = slash + 1;
+                }
+            }
+        }
+        return in_block_comment;
     }
 
 private:
+    // Consumes up to and including the closing `*/`, counting newlines.
+    void skip_block_comment(int& line_count)
+    {
+        while (peek().has_value()) {
+            if (peek().value() == '*' && peek(1).has_value() && peek(1).value() == '/') {
+                break;
+            }
+            if (consume() == '\n') {
+                line_count++;
+            }
+        }
+        if (peek().has_value()) {
+            consume();
+        }
+        if (peek().has_value()) {
+            consume();
+        }
+    }
+
     [[nodiscard]] std::optional<char> peek(const size_t offset = 0) const
     {
         if (m_index + offset >= m_src.length()) {
             return {};
         }
-        return m_src.at(m_index + offset);
+        return m_src[m_index + offset];
     }
 
     char consume()
     {
-        return m_src.at(m_index++);
+        return m_src[m_index++];
     }
 
-    const std::string m_src;
+    const std::string_view m_src;
+    int m_first_line;
+    const bool m_in_block_comment;
     size_t m_index = 0;
 };
+
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string src)
+        : m_src(std::move(src))
+    {
+    }
+
+    std::vector<Token> tokenize()
+    {
+        std::vector<Token> tokens;
+        if (!ChunkLexer(m_src, 1, false).lex(tokens)) {
+            invalid_token();
+        }
+        return tokens;
+    }
+
+    // Same result as tokenize(), lexing newline-aligned chunks on `threads`
+    // threads. Tokens never span lines, so only two things cross a chunk
+    // boundary: the line number, which is a prefix sum of newline counts,
+    // and being inside a block comment, which a cheap comment-only scan of
+    // every chunk (done in parallel for both possible entry states) resolves
+    // before the real lexing starts.
+    std::vector<Token> tokenize_parallel(const size_t threads)
+    {
+        const std::string_view src = m_src;
+        std::vector<size_t> bounds { 0 };
+        for (size_t i = 1; i < threads; i++) {
+            const size_t newline = src.find('\n', std::max(bounds.back(), src.size() * i / threads));
+            if (newline == std::string_view::npos) {
+                break;
+            }
+            bounds.push_back(newline + 1);
+        }
+        bounds.push_back(src.size());
+        const size_t chunks = bounds.size() - 1;
+        if (chunks == 1) {
+            return tokenize();
+        }
+        const auto chunk = [&](const size_t i) { return src.substr(bounds[i], bounds[i + 1] - bounds[i]); };
+        const auto parallel = [&](const auto& f) {
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < chunks; i++) {
+                workers.emplace_back(f, i);
+            }
+            f(0);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        };
+
+        // Prefix pass.
+        std::vector<size_t> newlines(chunks);
+        std::vector<std::array<bool, 2>> exit_state(chunks);
+        parallel([&](const size_t i) {
+            newlines[i] = static_cast<size_t>(std::ranges::count(chunk(i), '\n'));
+            exit_state[i] = { ChunkLexer::ends_in_block_comment(chunk(i), false),
+                              ChunkLexer::ends_in_block_comment(chunk(i), true) };
+        });
+        std::vector<int> first_line(chunks);
+        std::vector<char> in_comment(chunks);
+        first_line[0] = 1;
+        in_comment[0] = false;
+        for (size_t i = 1; i < chunks; i++) {
+            first_line[i] = first_line[i - 1] + static_cast<int>(newlines[i - 1]);
+            in_comment[i] = exit_state[i - 1][in_comment[i - 1]];
+        }
+
+        // Lex, then stitch the pieces into place.
+        std::vector<std::vector<Token>> pieces(chunks);
+        std::vector<char> ok(chunks);
+        parallel([&](const size_t i) {
+            pieces[i].reserve(chunk(i).size() / 4);
+            ok[i] = ChunkLexer(chunk(i), first_line[i], in_comment[i]).lex(pieces[i]);
+        });
+        if (std::ranges::find(ok, false) != ok.end()) {
+            invalid_token();
+        }
+        std::vector<size_t> offsets { 0 };
+        for (const auto& piece : pieces) {
+            offsets.push_back(offsets.back() + piece.size());
+        }
+        std::vector<Token> tokens(offsets.back());
+        parallel([&](const size_t i) {
+            std::ranges::move(pieces[i], tokens.begin() + static_cast<std::ptrdiff_t>(offsets[i]));
+        });
+        return tokens;
+    }
+
+private:
+    [[noreturn]] static void invalid_token()
+    {
+        std::cerr << "Invalid token" << std::endl;
+        compile_error();
+    }
+
+    const std::string m_src;
+};
@@ -1,4 +1,11 @@
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 using namespace std;
 #include "json.hpp"
 using json = nlohmann::json;
@@ -24,6 +31,7 @@ struct EnvConfig {
 };
 
 // ---------------------------- CSV Loader ----------------------------
+// Line-by-line reference loader; main uses loadCSVMapped, --bench-csv compares the two.
 static vector<vector<string>> loadCSV(const string& path, char delim=';') {
     vector<vector<string>> rows;
     ifstream f(path);
@@ -41,33 +49,148 @@ static vector<vector<string>> loadCSV(const string& path, char delim=';') {
     return rows;
 }
 
-// ---------------------------- Probability Table ----------------------------
-class ProbabilityTable {
+// Read-only memory map of a CSV file. forEachRow finds delimiters and
+// newlines 16 bytes at a time with SSE2 compares and hands out each row as
+// string_views into the mapping, splitting lines exactly like loadCSV (a
+// trailing delimiter adds no empty field; empty lines are skipped). Pipes,
+// FIFOs and other inputs that cannot be mapped are read into a buffer.
+class MappedCSV {
 public:
-    // P[end | start, action]
-    // key: (startIdx * 3 + actionIdx, endIdx) -> probability
-    vector<double> prob; // size 8*3*8
+    explicit MappedCSV(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            cerr << "[ERROR] Could not open file: " << path << "\n";
+            if (fd >= 0) close(fd);
+            return;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            char chunk[1 << 16];
+            ssize_t n;
+            while ((n = read(fd, chunk, sizeof chunk)) > 0 || (n < 0 && errno == EINTR)) {
+                if (n > 0) buffer.append(chunk, (size_t)n);
+            }
+            close(fd);
+            if (n < 0) { cerr << "[ERROR] Could not read file: " << path << "\n"; return; }
+            data = buffer.data();
+            size = buffer.size();
+            opened = true;
+            return;
+        }
+        size = (size_t)st.st_size;
+        if (size > 0) {
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                cerr << "[ERROR] Could not map file: " << path << "\n";
+                size = 0;
+            } else {
+                data = static_cast<const char*>(p);
+                mapped = true;
+                madvise(p, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        opened = size == 0 || data != nullptr;
+    }
+    MappedCSV(const MappedCSV&) = delete;
+    MappedCSV& operator=(const MappedCSV&) = delete;
+    ~MappedCSV() { if (mapped) munmap(const_cast<char*>(data), size); }
+
+    bool ok() const { return opened; }
+    size_t bytes() const { return size; }
+
+    // onRow(const vector<string_view>& fields) per non-empty line.
+    template<class F>
+    void forEachRow(F&& onRow, char delim=';') const { forEachRowIn(0, size, onRow, delim); }
+
+    // Same for the lines in [begin, end), where begin is the start of a line.
+    template<class F>
+    void forEachRowIn(size_t begin, size_t end, F&& onRow, char delim=';') const {
+        vector<string_view> fields; fields.reserve(16);
+        size_t fieldStart = begin;
+        auto finishRow = [&]() {
+            bool emptyLine = fields.size()==1 && fields[0].empty();
+            if (fields.size() > 1 && fields.back().empty()) fields.pop_back();
+            if (!emptyLine) onRow(fields);
+            fields.clear();
+        };
+        auto boundary = [&](size_t p) {
+            fields.emplace_back(data + fieldStart, p - fieldStart);
+            fieldStart = p + 1;
+            if (data[p] == '\n') finishRow();
+        };
+        size_t i = begin;
+#ifdef __SSE2__
+        const __m128i vd = _mm_set1_epi8(delim), vn = _mm_set1_epi8('\n');
+        for (; i + 16 <= end; i += 16) {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(b, vd), _mm_cmpeq_epi8(b, vn)));
+            while (mask) { boundary(i + __builtin_ctz(mask)); mask &= mask - 1; }
+        }
+#endif
+        for (; i < end; i++) if (data[i]==delim || data[i]=='\n') boundary(i);
+        if (fieldStart < end || !fields.empty()) {
+            fields.emplace_back(data + fieldStart, end - fieldStart);
+            finishRow();
+        }
+    }
+
+    // Cuts the file into up to n ranges of whole lines, as n+1 offsets.
+    vector<size_t> lineSplits(size_t n) const {
+        vector<size_t> cuts{0};
+        for (size_t k=1; k<n; k++) {
+            size_t at = max(cuts.back(), size*k/n);
+            const void* nl = at < size ? memchr(data + at, '\n', size - at) : nullptr;
+            if (!nl) break;
+            cuts.push_back((size_t)(static_cast<const char*>(nl) - data) + 1);
+        }
+        cuts.push_back(size);
+        return cuts;
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+    bool mapped = false; // data is an mmap of size bytes, else it points into buffer
+    string buffer;
+};
+
+// Same rows as loadCSV, without the per-line stream and getline copies.
+static vector<vector<string>> loadCSVMapped(const string& path, char delim=';') {
+    vector<vector<string>> rows;
+    MappedCSV csv(path);
+    csv.forEachRow([&](const vector<string_view>& f) { rows.emplace_back(f.begin(), f.end()); }, delim);
+    return rows;
+}
 
-    ProbabilityTable() { prob.assign(8*3*8, 0.0); }
+// ---------------------------- Probability Table ----------------------------
+// P[end | start, action] for S states and A actions, in fixed-size storage
+// (8*3*8 doubles = 1.5 KB for the intersection model).
+template<int S, int A>
+class BasicProbabilityTable {
+public:
+    // key: (startIdx * A + actionIdx, endIdx) -> probability
+    array<double,S*A*S> prob{};
 
-    static int idx(int start, int a, int end) { return (start*3 + a)*8 + end; }
+    static constexpr int idx(int start, int a, int end) { return (start*A + a)*S + end; }
 
     double get(int start, int a, int end) const { return prob[idx(start,a,end)]; }
 
     void build(const vector<vector<string>>& mdata,
                const vector<Triple>& states,
-               const array<char,3>& actions) {
+               const array<char,A>& actions) {
         // Count occurrences from raw data
-        vector<double> totals(8*3, 0.0);
+        array<uint64_t,S*A*S> counts{};
         auto stateIndex = [&](const string& ns, const string& es, const string& ws) -> int {
-            for (int i=0;i<8;i++) {
+            for (int i=0;i<S;i++) {
                 if (states[i].n==ns && states[i].e==es && states[i].w==ws) return i;
             }
             return -1;
         };
         auto actionIndex = [&](const string& act)->int{
             if (act.empty()) return -1;
-            for (int i=0;i<3;i++) if (actions[i]==act[0]) return i;
+            for (int i=0;i<A;i++) if (actions[i]==act[0]) return i;
             return -1;
         };
 
@@ -78,23 +201,25 @@ public:
             int a = actionIndex(row[3]);
             int e = stateIndex(row[4], row[5], row[6]);
             if (s<0 || a<0 || e<0) continue;
-            totals[s*3 + a] += 1.0;
-            prob[idx(s,a,e)] += 1.0;
+            counts[idx(s,a,e)]++;
         }
-        // Normalize
-        for (int s=0;s<8;s++) {
-            for (int a=0;a<3;a++) {
-                double t = totals[s*3 + a];
-                if (t <= 0) {
-                    // leave zeros
-                } else {
-                    for (int e=0;e<8;e++) prob[idx(s,a,e)] /= t;
-                }
+        setFromCounts(counts);
+    }
+
+    // Normalizes transition counts, indexed like prob, into probabilities.
+    void setFromCounts(const array<uint64_t,S*A*S>& counts) {
+        for (int s=0;s<S;s++) {
+            for (int a=0;a<A;a++) {
+                uint64_t t = 0;
+                for (int e=0;e<S;e++) t += counts[idx(s,a,e)];
+                for (int e=0;e<S;e++) prob[idx(s,a,e)] = t == 0 ? 0.0 : (double)counts[idx(s,a,e)] / (double)t;
             }
         }
     }
 };
 
+using ProbabilityTable = BasicProbabilityTable<8,3>;
+
 // ---------------------------- Cost Model ----------------------------
 struct CostModel {
     // costs for actions [N, W, E]
@@ -155,27 +280,278 @@ struct CostModel {
     }
 };
 
+// ---------------------------- Value Iteration ----------------------------
+// Solvers shared by the fixed-size, runtime-sized and sparse models. A model
+// provides numStates(), numActions(), qValue(s,a) (against Vprev),
+// forEachTransition(f) calling f(s,a,end,p) for every nonzero probability, and
+// the V, Vprev, goal, iterations, updates and solveSeconds members. The goal
+// state stays pinned to 0.
+//
+//   jacobi        every sweep reads only the previous sweep's values
+//   gauss-seidel  sweeps in place, so later states see this sweep's updates
+//   sor           in place, moving each value omega times the Bellman step
+//   prioritized   updates one state at a time, largest Bellman residual
+//                 first, raising the residual bounds of the states that
+//                 lead into it
+enum class SolverMode { Jacobi, GaussSeidel, SOR, Prioritized };
+
+struct SolverOptions {
+    SolverMode mode = SolverMode::Jacobi;
+    double omega = 1.2; // SOR relaxation factor, in (0, 2); 1 is Gauss-Seidel
+};
+
+static const char* solverName(SolverMode mode) {
+    switch (mode) {
+        case SolverMode::Jacobi: return "jacobi";
+        case SolverMode::GaussSeidel: return "gauss-seidel";
+        case SolverMode::SOR: return "sor";
+        case SolverMode::Prioritized: return "prioritized";
+    }
+    return "?";
+}
+
+static bool parseSolverMode(const string& name, SolverMode& mode) {
+    for (SolverMode m : {SolverMode::Jacobi, SolverMode::GaussSeidel, SolverMode::SOR, SolverMode::Prioritized}) {
+        if (name == solverName(m)) { mode = m; return true; }
+    }
+    return false;
+}
+
+template<class Model>
+static double bestQOf(const Model& m, int s) {
+    double best = m.qValue(s,0);
+    for (int a=1;a<m.numActions();a++) best = min(best, m.qValue(s,a));
+    return best;
+}
+
+template<class Model>
+static void jacobiOn(Model& m, double tol, int maxIters) {
+    for (int it=0; it<maxIters; ++it) {
+        // write this sweep into V, then swap it in as the next Vprev
+        for (int s=0;s<m.numStates();s++) m.V[s] = s==m.goal ? 0.0 : bestQOf(m,s);
+        m.updates += m.numStates() - 1;
+        // convergence check
+        double maxDiff = 0.0;
+        for (int s=0;s<m.numStates();s++) maxDiff = max(maxDiff, fabs(m.V[s]-m.Vprev[s]));
+        swap(m.V, m.Vprev);
+        m.iterations = it+1;
+        if (maxDiff < tol) break;
+    }
+}
+
+// Gauss-Seidel for omega == 1, over-relaxation above it.
+template<class Model>
+static void sweepInPlaceOn(Model& m, double tol, int maxIters, double omega) {
+    for (int it=0; it<maxIters; ++it) {
+        double maxDiff = 0.0;
+        for (int s=0;s<m.numStates();s++) {
+            if (s==m.goal) continue;
+            double step = omega * (bestQOf(m,s) - m.Vprev[s]);
+            m.Vprev[s] += step;
+            maxDiff = max(maxDiff, fabs(step));
+        }
+        m.updates += m.numStates() - 1;
+        m.iterations = it+1;
+        if (maxDiff < tol) break;
+    }
+}
+
+// Binary max-heap over state indices keyed by an external array, with one
+// slot per state, so raising a key sifts the entry up instead of pushing a
+// duplicate.
+class StateHeap {
+public:
+    explicit StateHeap(const vector<double>& key) : key(key), pos(key.size(), -1) {}
+
+    bool empty() const { return heap.empty(); }
+
+    // Insert s, or restore order after key[s] has grown.
+    void raise(int s) {
+        if (pos[s] < 0) { pos[s] = (int)heap.size(); heap.push_back(s); }
+        siftUp(pos[s]);
+    }
+
+    int pop() {
+        int top = heap[0];
+        pos[top] = -1;
+        int last = heap.back(); heap.pop_back();
+        if (!heap.empty()) { heap[0] = last; pos[last] = 0; siftDown(0); }
+        return top;
+    }
+
+private:
+    const vector<double>& key;
+    vector<int> pos, heap;
+
+    void place(int i, int s) { heap[i] = s; pos[s] = i; }
+    void siftUp(int i) {
+        int s = heap[i];
+        while (i > 0 && key[heap[(i-1)/2]] < key[s]) { place(i, heap[(i-1)/2]); i = (i-1)/2; }
+        place(i, s);
+    }
+    void siftDown(int i) {
+        int s = heap[i], n = (int)heap.size();
+        for (int c; (c = 2*i+1) < n; i = c) {
+            if (c+1 < n && key[heap[c+1]] > key[heap[c]]) c++;
+            if (key[heap[c]] <= key[s]) break;
+            place(i, heap[c]);
+        }
+        place(i, s);
+    }
+};
+
+// Each state carries an upper bound on its Bellman residual: a backup that
+// moves V[e] by d can change a predecessor's residual by at most
+// max_a P(e|s,a) * d, so predecessors are re-scored without a backup of their
+// own. Stops once every bound is below tol, or after maxIters sweeps' worth of
+// updates; iterations reports sweep equivalents.
+template<class Model>
+static void prioritizedOn(Model& m, double tol, int maxIters) {
+    const int S = m.numStates();
+    vector<vector<pair<int,double>>> preds(S); // (s, max_a P(e|s,a)) for each end state e
+    m.forEachTransition([&](int s, int, int e, double p) {
+        if (s == m.goal) return;
+        auto& in = preds[e];
+        if (!in.empty() && in.back().first == s) in.back().second = max(in.back().second, p);
+        else in.push_back({s, p});
+    });
+
+    vector<double> bound(S, 0.0);
+    StateHeap queue(bound);
+    for (int s=0;s<S;s++) {
+        if (s == m.goal) continue;
+        bound[s] = fabs(bestQOf(m,s) - m.Vprev[s]);
+        if (bound[s] >= tol) queue.raise(s);
+    }
+    const size_t budget = (size_t)maxIters * max(1, S-1);
+    while (!queue.empty() && m.updates < budget) {
+        int s = queue.pop();
+        double v = bestQOf(m,s), d = fabs(v - m.Vprev[s]);
+        m.Vprev[s] = v;
+        bound[s] = 0.0;
+        m.updates++;
+        for (auto [p, prob] : preds[s]) {
+            bound[p] += prob * d;
+            if (bound[p] >= tol) queue.raise(p);
+        }
+    }
+    m.iterations = (int)((m.updates + max(1, S-1) - 1) / max(1, S-1));
+}
+
+template<class Model>
+static void runValueIterationOn(Model& m, double tol, int maxIters, const SolverOptions& opts = {}) {
+    auto t0 = chrono::steady_clock::now();
+    fill(m.V.begin(), m.V.end(), 0.0); fill(m.Vprev.begin(), m.Vprev.end(), 0.0);
+    m.iterations = 0;
+    m.updates = 0;
+    switch (opts.mode) {
+        case SolverMode::Jacobi: jacobiOn(m, tol, maxIters); break;
+        case SolverMode::GaussSeidel: sweepInPlaceOn(m, tol, maxIters, 1.0); break;
+        case SolverMode::SOR: sweepInPlaceOn(m, tol, maxIters, opts.omega); break;
+        case SolverMode::Prioritized: prioritizedOn(m, tol, maxIters); break;
+    }
+    m.V = m.Vprev;
+    m.solveSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Cheapest action in state s; ties go to the lower action index.
+template<class Model>
+static int bestActionOf(const Model& m, int s) {
+    int best = 0; double q = m.qValue(s,0);
+    for (int a=1;a<m.numActions();a++) {
+        double qa = m.qValue(s,a);
+        if (qa < q) { q = qa; best = a; }
+    }
+    return best;
+}
+
+// Compile-time sized MDP core: all storage is std::array and the loop trip
+// counts are constants, so the Bellman backup unrolls and a re-solve of the
+// 8-state model (~1.7 KB in all) runs out of L1.
+template<int S, int A>
+class BasicTrafficMDP {
+public:
+    static constexpr int MAX_ITERS = 200;
+
+    BasicProbabilityTable<S,A> P; // transition probabilities
+    array<double,A> cost{};       // action costs
+    array<double,S> V{};          // current values
+    array<double,S> Vprev{};      // previous iteration
+    int goal = 0;
+    int iterations = 0;
+    size_t updates = 0;           // single-state backups in the last solve
+    double solveSeconds = 0;
+
+    static constexpr int numStates() { return S; }
+    static constexpr int numActions() { return A; }
+
+    double qValue(int s, int a) const {
+        // cost[a] + sum_e P[e|s,a] * Vprev[e]
+        double q = cost[a];
+        for (int e=0;e<S;e++) q += P.get(s,a,e) * Vprev[e];
+        return q;
+    }
+
+    template<class F>
+    void forEachTransition(F f) const {
+        for (int s=0;s<S;s++) for (int a=0;a<A;a++) for (int e=0;e<S;e++) if (P.get(s,a,e) != 0) f(s,a,e,P.get(s,a,e));
+    }
+
+    void runValueIteration(double tol=1e-6, const SolverOptions& opts={}) { runValueIterationOn(*this, tol, MAX_ITERS, opts); }
+};
+
+// Same model with sizes chosen at runtime, for state spaces too large to
+// instantiate per size.
+class DynamicTrafficMDP {
+public:
+    static constexpr int MAX_ITERS = 200;
+
+    int S = 0, A = 0;
+    vector<double> prob;  // (start*A + action)*S + end
+    vector<double> cost;
+    vector<double> V, Vprev;
+    int goal = 0;
+    int iterations = 0;
+    size_t updates = 0;
+    double solveSeconds = 0;
+
+    DynamicTrafficMDP(int states, int actions)
+        : S(states), A(actions), prob((size_t)states*actions*states, 0.0), cost(actions, 0.0),
+          V(states, 0.0), Vprev(states, 0.0) {}
+
+    int numStates() const { return S; }
+    int numActions() const { return A; }
+
+    double get(int start, int a, int end) const { return prob[((size_t)start*A + a)*S + end]; }
+
+    double qValue(int s, int a) const {
+        double q = cost[a];
+        const double* row = &prob[((size_t)s*A + a)*S];
+        for (int e=0;e<S;e++) q += row[e] * Vprev[e];
+        return q;
+    }
+
+    template<class F>
+    void forEachTransition(F f) const {
+        for (int s=0;s<S;s++) for (int a=0;a<A;a++) for (int e=0;e<S;e++) if (get(s,a,e) != 0) f(s,a,e,get(s,a,e));
+    }
+
+    void runValueIteration(double tol=1e-6, const SolverOptions& opts={}) { runValueIterationOn(*this, tol, MAX_ITERS, opts); }
+};
+
 // ---------------------------- Traffic Model (MDP) ----------------------------
-class TrafficMDP {
+class TrafficMDP : public BasicTrafficMDP<8,3> {
 public:
     // States in fixed order matching the Python code
     // 0: HHL, 1: HLL, 2: LLL (goal), 3: LLH, 4: HHH, 5: LHL, 6: LHH, 7: HLH
     vector<Triple> states;
     array<char,3> actions {'N','W','E'}; // NOTE: Python used ["N","E","W"] but cost uses [N,W,E]. We'll keep [N,W,E] consistently
 
-    ProbabilityTable P;     // transition probabilities
-    array<double,3> cost{}; // action costs
-
-    // Value iteration data
-    static constexpr int MAX_ITERS = 200;
-    vector<double> V;     // size 8, current values
-    vector<double> Vprev; // previous iteration
-    int iterations = 0;
-
     // Policy per state at convergence (N/W/E or "Goal")
     vector<string> policy; // size 8
 
-    TrafficMDP(): states(8), V(8,0.0), Vprev(8,0.0), policy(8, "") {
+    TrafficMDP(): states(8), policy(8, "") {
+        goal = 2;
         states[0] = {"High","High","Low"};    // HHL
         states[1] = {"High","Low","Low"};     // HLL
         states[2] = {"Low","Low","Low"};      // LLL goal
@@ -194,48 +570,488 @@ public:
         P.build(mdata, states, actions);
     }
 
+    // Single pass over the mapped CSV: each row's High/Low cells are read as
+    // the bits of a 3-bit code, mapped to a state index through a table and
+    // counted in place, so memory does not grow with the input. With several
+    // threads the file is cut at line boundaries and every worker counts into
+    // its own cache-line-aligned histogram; the histograms are summed before
+    // normalizing, so the result is the same for any thread count. 0 threads:
+    // one per core for inputs over 8 MB. Returns the number of rows read.
+    size_t buildProbabilities(const MappedCSV& csv, unsigned threads=1) {
+        auto level = [](string_view v) -> int { return v=="High" ? 1 : v=="Low" ? 0 : -1; };
+        array<int,8> stateOfCode; stateOfCode.fill(-1);
+        for (int i=0;i<8;i++) {
+            int n = level(states[i].n), e = level(states[i].e), w = level(states[i].w);
+            if (n>=0 && e>=0 && w>=0) stateOfCode[n<<2 | e<<1 | w] = i;
+        }
+        array<int,256> actionOfChar; actionOfChar.fill(-1);
+        for (int a=2;a>=0;a--) actionOfChar[(unsigned char)actions[a]] = a;
+        auto state = [&](const string_view* f) -> int {
+            int n = level(f[0]), e = level(f[1]), w = level(f[2]);
+            return (n|e|w) < 0 ? -1 : stateOfCode[n<<2 | e<<1 | w];
+        };
+
+        // Padded to whole cache lines so neighbouring workers never share one.
+        struct alignas(64) Histogram {
+            array<uint64_t,8*3*8> counts{};
+            size_t rows = 0;
+        };
+        if (threads == 0) threads = csv.bytes() > (8u << 20) ? max(1u, thread::hardware_concurrency()) : 1;
+        vector<size_t> cuts = csv.lineSplits(threads);
+        vector<Histogram> hist(cuts.size() - 1);
+        auto work = [&](size_t k) {
+            Histogram& h = hist[k];
+            // Expect 7 columns: 0..2 start, 3 action, 4..6 end
+            csv.forEachRowIn(cuts[k], cuts[k+1], [&](const vector<string_view>& row) {
+                h.rows++;
+                if (row.size() < 7 || row[3].empty()) return;
+                int s = state(&row[0]);
+                int a = actionOfChar[(unsigned char)row[3][0]];
+                int e = state(&row[4]);
+                if (s<0 || a<0 || e<0) return;
+                h.counts[ProbabilityTable::idx(s,a,e)]++;
+            });
+        };
+        vector<thread> workers;
+        for (size_t k=1; k<hist.size(); k++) workers.emplace_back(work, k);
+        work(0);
+        for (auto& w : workers) w.join();
+
+        array<uint64_t,8*3*8> counts{};
+        size_t rows = 0;
+        for (const auto& h : hist) {
+            for (size_t i=0; i<counts.size(); i++) counts[i] += h.counts[i];
+            rows += h.rows;
+        }
+        P.setFromCounts(counts);
+        return rows;
+    }
+
     void setCosts(const array<double,3>& c) { cost = c; }
 
+    void runValueIteration(double tol=1e-6, const SolverOptions& opts={}) {
+        BasicTrafficMDP::runValueIteration(tol, opts);
+        // Extract policy
+        policy.assign(8,"");
+        for (int s=0;s<8;s++) {
+            if (s==goal) { policy[s] = "Goal"; continue; }
+            policy[s] = string(1, actions[bestActionOf(*this, s)]);
+        }
+    }
+};
+
+// Re-solves the model repeatedly with the fixed-size and the runtime-sized
+// core and reports the time per solve.
+static void benchSolve(const TrafficMDP& mdp, int reps) {
+    BasicTrafficMDP<8,3> fixedMdp = mdp;
+    DynamicTrafficMDP dynMdp(8, 3);
+    copy(mdp.P.prob.begin(), mdp.P.prob.end(), dynMdp.prob.begin());
+    copy(mdp.cost.begin(), mdp.cost.end(), dynMdp.cost.begin());
+    dynMdp.goal = mdp.goal;
+
+    auto timeIt = [&](auto& m) {
+        auto t0 = chrono::steady_clock::now();
+        volatile double sink = 0; // keeps the solves from being optimized out
+        for (int r=0;r<reps;r++) { m.runValueIteration(1e-6); sink = sink + m.Vprev[0]; }
+        auto t1 = chrono::steady_clock::now();
+        return chrono::duration<double, nano>(t1-t0).count() / reps;
+    };
+    double nsFixed = timeIt(fixedMdp);
+    double nsDyn = timeIt(dynMdp);
+    bool same = equal(fixedMdp.Vprev.begin(), fixedMdp.Vprev.end(), dynMdp.Vprev.begin());
+    cout << "[BENCH] value iteration, " << fixedMdp.iterations << " sweeps, " << reps << " solves\n";
+    cout << "  fixed   BasicTrafficMDP<8,3>: " << fixed << setprecision(0) << nsFixed << " ns/solve\n";
+    cout << "  dynamic DynamicTrafficMDP   : " << nsDyn << " ns/solve\n";
+    cout << "  speedup: " << setprecision(2) << nsDyn/nsFixed << "x, values " << (same ? "match" : "DIFFER") << "\n";
+}
+
+// Loader throughput on the given CSV repeated up to `mb` megabytes.
+static void benchCSV(const string& path, size_t mb) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) { cerr << "[ERROR] Could not open file: " << path << "\n"; return; }
+    string seed((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    if (!seed.empty() && seed.back() != '\n') seed.push_back('\n');
+    string scaled = (filesystem::temp_directory_path() / ("traffic-bench-" + to_string(getpid()) + ".csv")).string();
+    {
+        ofstream out(scaled, ios::binary);
+        for (size_t written = 0; !seed.empty() && written < mb*1000000; written += seed.size()) out << seed;
+    }
+    auto report = [&](const char* name, double sec, size_t rows, size_t bytes) {
+        cout << "  " << left << setw(22) << name << right << fixed << setprecision(3) << setw(9) << sec << " s "
+             << setprecision(2) << setw(9) << rows/sec/1e6 << " M rows/s " << setw(7) << bytes/sec/1e9 << " GB/s\n";
+    };
+    size_t bytes = filesystem::file_size(scaled);
+    cout << "[BENCH] " << scaled << ": " << fixed << setprecision(1) << bytes/1e6 << " MB\n";
+
+    auto t0 = chrono::steady_clock::now();
+    auto reference = loadCSV(scaled, ';');
+    double refSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    report("getline + stringstream", refSec, reference.size(), bytes);
+
+    t0 = chrono::steady_clock::now();
+    size_t rows = 0, fieldBytes = 0;
+    {
+        MappedCSV csv(scaled);
+        csv.forEachRow([&](const vector<string_view>& f) { rows++; for (auto& x : f) fieldBytes += x.size(); });
+    }
+    double scanSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    report("mmap + SSE2 scan", scanSec, rows, bytes);
+
+    t0 = chrono::steady_clock::now();
+    auto mapped = loadCSVMapped(scaled, ';');
+    double mappedSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    report("mmap + SSE2 to rows", mappedSec, mapped.size(), bytes);
+
+    TrafficMDP rowsMdp, streamMdp;
+    t0 = chrono::steady_clock::now();
+    rowsMdp.buildProbabilities(reference);
+    double buildSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    t0 = chrono::steady_clock::now();
+    {
+        MappedCSV csv(scaled);
+        streamMdp.buildProbabilities(csv);
+    }
+    double streamSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    report("rows, then build", refSec + buildSec, reference.size(), bytes);
+    report("streaming build", streamSec, reference.size(), bytes);
+
+    bool parallelSame = true;
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 2; threads <= max(4u, cores); threads *= 2) {
+        TrafficMDP parMdp;
+        t0 = chrono::steady_clock::now();
+        {
+            MappedCSV csv(scaled);
+            parMdp.buildProbabilities(csv, threads);
+        }
+        double parSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        string name = "streaming, " + to_string(threads) + " threads";
+        report(name.c_str(), parSec, reference.size(), bytes);
+        parallelSame = parallelSame && parMdp.P.prob == streamMdp.P.prob;
+    }
+    cout << "  (" << cores << " cores)\n";
+
+    size_t refFieldBytes = 0;
+    for (auto& r : reference) for (auto& x : r) refFieldBytes += x.size();
+    bool same = mapped == reference && rows == reference.size() && fieldBytes == refFieldBytes;
+    cout << "  scan speedup " << setprecision(1) << refSec/scanSec << "x, rows " << (same ? "match" : "DIFFER")
+         << "; build speedup " << (refSec + buildSec)/streamSec << "x, probabilities "
+         << (rowsMdp.P.prob == streamMdp.P.prob && parallelSame ? "match" : "DIFFER") << "\n";
+    filesystem::remove(scaled);
+}
+
+// ---------------------------- Generalized Model ----------------------------
+// D approaches with K congestion levels each, so K^D states. Rows hold the D
+// start levels, the action and the D end levels. Observed transitions are
+// local, so most of the S*A*S dense table would be zeros; they are kept in
+// CSR form instead, one row per (state, action).
+struct StateSchema {
+    vector<string> directions{"N","E","W"};
+    vector<string> levels{"Low","High"}; // least congested first; all-lowest is the goal
+    vector<string> actions{"N","W","E"};
+    vector<double> costs;                // per action; empty: CostModel's N/W/E costs
+
+    int numStates() const {
+        int n = 1;
+        for (size_t d=0; d<directions.size(); d++) n *= (int)levels.size();
+        return n;
+    }
+    int numActions() const { return (int)actions.size(); }
+    int columns() const { return 2*(int)directions.size() + 1; }
+
+    // Reads "key=a,b,c" cells for directions, levels, actions and costs, as
+    // found in a "#directions=N,E,W,S;levels=Low,Mid,High;..." CSV header line
+    // or a --schema file. Returns false with a message in err.
+    bool parse(const vector<string>& cells, string& err) {
+        for (string cell : cells) {
+            if (!cell.empty() && cell[0]=='#') cell.erase(0,1);
+            size_t eq = cell.find('=');
+            if (cell.find_first_not_of(" \t\r") == string::npos) continue;
+            if (eq == string::npos) { err = "expected key=value, got '" + cell + "'"; return false; }
+            string key = cell.substr(0,eq);
+            key.erase(remove_if(key.begin(), key.end(), ::isspace), key.end());
+            vector<string> vals; string v; stringstream ss(cell.substr(eq+1));
+            while (getline(ss, v, ',')) {
+                v.erase(remove_if(v.begin(), v.end(), ::isspace), v.end());
+                if (!v.empty()) vals.push_back(v);
+            }
+            if (key=="directions") directions = vals;
+            else if (key=="levels") levels = vals;
+            else if (key=="actions") actions = vals;
+            else if (key=="costs") {
+                costs.clear();
+                for (auto& c : vals) {
+                    char* end = nullptr;
+                    double x = strtod(c.c_str(), &end);
+                    if (end == c.c_str() || *end != '\0' || !isfinite(x)) { err = "bad cost '" + c + "'"; return false; }
+                    costs.push_back(x);
+                }
+            }
+            else { err = "unknown schema key '" + key + "'"; return false; }
+        }
+        if (directions.empty() || levels.size() < 2 || actions.empty()) { err = "need directions, two or more levels and actions"; return false; }
+        if (pow((double)levels.size(), (double)directions.size()) > 1e7) { err = "too many states"; return false; }
+        if (!costs.empty() && costs.size() != actions.size()) { err = "need one cost per action"; return false; }
+        return true;
+    }
+
+    // Costs per action, filling in CostModel's for actions named N, W and E.
+    bool resolveCosts(const CostModel& cm, string& err) {
+        if (!costs.empty()) return true;
+        for (auto& a : actions) {
+            if (a=="N") costs.push_back(cm.cost[0]);
+            else if (a=="W") costs.push_back(cm.cost[1]);
+            else if (a=="E") costs.push_back(cm.cost[2]);
+            else { err = "no cost for action '" + a + "'; give costs= in the schema"; return false; }
+        }
+        return true;
+    }
+
+    // State of the D level cells starting at row[first], direction 0 most significant; -1 if invalid.
+    int encode(const vector<string>& row, size_t first) const {
+        int s = 0;
+        for (size_t d=0; d<directions.size(); d++) {
+            int lv = -1;
+            for (size_t k=0; k<levels.size(); k++) if (levels[k]==row[first+d]) { lv = (int)k; break; }
+            if (lv < 0) return -1;
+            s = s*(int)levels.size() + lv;
+        }
+        return s;
+    }
+
+    int actionIndex(const string& act) const {
+        for (size_t a=0; a<actions.size(); a++) if (actions[a]==act) return (int)a;
+        return -1;
+    }
+
+    // First letter of each direction's level, e.g. "HHL".
+    string code(int s) const {
+        string c(directions.size(), '?');
+        for (int d=(int)directions.size()-1; d>=0; d--) { c[d] = levels[s % levels.size()][0]; s /= (int)levels.size(); }
+        return c;
+    }
+};
+
+// Transition probabilities in compressed sparse rows: the successors of
+// (s,a) are col[rowPtr[s*A+a] .. rowPtr[s*A+a+1]), ascending, with their
+// probabilities in val.
+struct CsrTransitions {
+    int S = 0, A = 0;
+    vector<uint32_t> rowPtr;
+    vector<int32_t> col;
+    vector<double> val;
+
+    // keys are (s*A + a)*S + end, one per observed transition; sorted in place.
+    static CsrTransitions fromKeys(int S, int A, vector<uint64_t>& keys) {
+        CsrTransitions t; t.S = S; t.A = A;
+        t.rowPtr.assign((size_t)S*A + 1, 0);
+        sort(keys.begin(), keys.end());
+        size_t i = 0;
+        while (i < keys.size()) {
+            size_t row = keys[i] / S;
+            size_t rowEnd = i;
+            while (rowEnd < keys.size() && keys[rowEnd] / S == row) rowEnd++;
+            double total = (double)(rowEnd - i);
+            while (i < rowEnd) {
+                size_t j = i;
+                while (j < rowEnd && keys[j] == keys[i]) j++;
+                t.col.push_back((int32_t)(keys[i] % S));
+                t.val.push_back((double)(j - i) / total);
+                i = j;
+            }
+            t.rowPtr[row+1] = (uint32_t)t.col.size();
+        }
+        for (size_t r=1; r<t.rowPtr.size(); r++) t.rowPtr[r] = max(t.rowPtr[r], t.rowPtr[r-1]);
+        return t;
+    }
+
+    size_t nnz() const { return col.size(); }
+    size_t bytes() const { return rowPtr.size()*sizeof(uint32_t) + col.size()*sizeof(int32_t) + val.size()*sizeof(double); }
+};
+
+class SparseTrafficMDP {
+public:
+    static constexpr int MAX_ITERS = 200;
+
+    CsrTransitions T;
+    vector<double> cost;
+    vector<double> V, Vprev;
+    int goal = 0;
+    int iterations = 0;
+    size_t updates = 0;
+    double solveSeconds = 0;
+
+    SparseTrafficMDP(CsrTransitions t, vector<double> costs)
+        : T(std::move(t)), cost(std::move(costs)), V(T.S, 0.0), Vprev(T.S, 0.0) {}
+
+    int numStates() const { return T.S; }
+    int numActions() const { return T.A; }
+
     double qValue(int s, int a) const {
-        // cost[a] + sum_e P[e|s,a] * Vprev[e]
+        // Same summation order as the dense table, minus its zero terms
         double q = cost[a];
-        for (int e=0;e<8;e++) q += P.get(s,a,e) * Vprev[e];
+        size_t r = (size_t)s*T.A + a;
+        for (uint32_t k=T.rowPtr[r]; k<T.rowPtr[r+1]; k++) q += T.val[k] * Vprev[T.col[k]];
         return q;
     }
 
-    void runValueIteration(double tol=1e-6) {
-        // Goal state (index 2) pinned to 0
-        V.assign(8,0.0); Vprev.assign(8,0.0); V[2]=0.0; Vprev[2]=0.0;
-        iterations = 0;
-        for (int it=0; it<MAX_ITERS; ++it) {
-            V = Vprev; // start from previous; we'll write into V this round then compare
-            for (int s=0;s<8;s++) {
-                if (s==2) { V[s]=0.0; continue; }
-                double qN = qValue(s,0);
-                double qW = qValue(s,1);
-                double qE = qValue(s,2);
-                V[s] = min({qN,qW,qE});
+    template<class F>
+    void forEachTransition(F f) const {
+        for (int s=0;s<T.S;s++) {
+            for (int a=0;a<T.A;a++) {
+                size_t r = (size_t)s*T.A + a;
+                for (uint32_t k=T.rowPtr[r]; k<T.rowPtr[r+1]; k++) f(s, a, T.col[k], T.val[k]);
             }
-            // convergence check
-            double maxDiff = 0.0;
-            for (int s=0;s<8;s++) maxDiff = max(maxDiff, fabs(V[s]-Vprev[s]));
-            Vprev = V; // next iteration will use this as previous
-            iterations = it+1;
-            if (maxDiff < tol) break;
-        }
-        // Extract policy
-        policy.assign(8,"");
-        for (int s=0;s<8;s++) {
-            if (s==2) { policy[s] = "Goal"; continue; }
-            double qN = qValue(s,0);
-            double qW = qValue(s,1);
-            double qE = qValue(s,2);
-            double m = min({qN,qW,qE});
-            if (m==qN) policy[s] = "N"; else if (m==qW) policy[s] = "W"; else policy[s] = "E";
         }
     }
+
+    void runValueIteration(double tol=1e-6, const SolverOptions& opts={}) { runValueIterationOn(*this, tol, MAX_ITERS, opts); }
 };
 
+// Transition keys for the rows of a CSV in the schema's layout; skips '#' lines and malformed rows.
+static vector<uint64_t> transitionKeys(const vector<vector<string>>& rows, const StateSchema& sc) {
+    vector<uint64_t> keys; keys.reserve(rows.size());
+    const size_t D = sc.directions.size();
+    const uint64_t S = sc.numStates(), A = sc.numActions();
+    for (const auto& row : rows) {
+        if (row.size() < (size_t)sc.columns() || (!row[0].empty() && row[0][0]=='#')) continue;
+        int s = sc.encode(row, 0);
+        int a = sc.actionIndex(row[D]);
+        int e = sc.encode(row, D+1);
+        if (s<0 || a<0 || e<0) continue;
+        keys.push_back((s*A + a)*S + e);
+    }
+    return keys;
+}
+
+// Solves the generalized model for a CSV and prints the value and policy per state.
+static int runGeneral(const vector<vector<string>>& rows, StateSchema sc, const CostModel& cm, const SolverOptions& solver) {
+    string err;
+    if (!sc.resolveCosts(cm, err)) { cerr << "[ERROR] Schema: " << err << "\n"; return 1; }
+    vector<uint64_t> keys = transitionKeys(rows, sc);
+    SparseTrafficMDP mdp(CsrTransitions::fromKeys(sc.numStates(), sc.numActions(), keys), sc.costs);
+    mdp.runValueIteration(1e-6, solver);
+    cout << "[GENERAL] " << sc.directions.size() << " directions x " << sc.levels.size() << " levels: "
+         << mdp.numStates() << " states, " << keys.size() << " transitions, " << mdp.T.nnz() << " nonzeros, "
+         << mdp.iterations << " iterations (" << solverName(solver.mode) << ", " << fixed << setprecision(1)
+         << mdp.solveSeconds*1e3 << " ms)\n";
+    for (int s=0; s<mdp.numStates(); s++) {
+        cout << sc.code(s) << ": V=" << fixed << setprecision(4) << mdp.Vprev[s] << " policy="
+             << (s==mdp.goal ? string("Goal") : sc.actions[bestActionOf(mdp, s)]) << "\n";
+    }
+    return 0;
+}
+
+// Synthetic transition keys for D approaches with K levels (and D actions):
+// each step moves every approach's level by at most one, and the served
+// approach tends to clear.
+static vector<uint64_t> syntheticKeys(int D, int K, size_t rows, mt19937_64& rng) {
+    int S = 1; for (int d=0; d<D; d++) S *= K;
+    const int A = D;
+    vector<uint64_t> keys; keys.reserve(rows);
+    vector<int> lv(D);
+    for (size_t r=0; r<rows; r++) {
+        int s = (int)(rng() % S), a = (int)(rng() % A), e = 0;
+        for (int d=D-1, x=s; d>=0; d--) { lv[d] = x % K; x /= K; }
+        for (int d=0; d<D; d++) {
+            int step = (int)(rng() % 3) - 1 - (d==a && rng()%2 ? 1 : 0);
+            e = e*K + clamp(lv[d] + step, 0, K-1);
+        }
+        keys.push_back(((uint64_t)s*A + a)*S + e);
+    }
+    return keys;
+}
+
+// Dense versus CSR on synthetic data. Dense tables over 1 GB are skipped.
+static void benchSparse(const vector<pair<int,int>>& shapes, size_t rows) {
+    cout << "[BENCH] " << rows << " transitions per model\n";
+    cout << "(build = count and normalize, solve = value iteration; times in ms)\n";
+    cout << left << setw(8) << "D x K" << right << setw(8) << "states" << setw(11) << "nonzeros" << setw(7) << "iters"
+         << setw(11) << "dense MB" << setw(9) << "CSR MB" << setw(13) << "dense build" << setw(11) << "CSR build"
+         << setw(13) << "dense solve" << setw(11) << "CSR solve" << setw(9) << "speedup" << "  values\n";
+    mt19937_64 rng(42);
+    for (auto [D, K] : shapes) {
+        int S = 1; for (int d=0; d<D; d++) S *= K;
+        const int A = D;
+        vector<uint64_t> keys = syntheticKeys(D, K, rows, rng);
+        vector<double> costs(A);
+        for (int a=0; a<A; a++) costs[a] = 20.0 + 5.0*a;
+
+        auto since = [](chrono::steady_clock::time_point t) {
+            return chrono::duration<double, milli>(chrono::steady_clock::now() - t).count();
+        };
+        auto t0 = chrono::steady_clock::now();
+        SparseTrafficMDP sparse(CsrTransitions::fromKeys(S, A, keys), costs);
+        double csrBuild = since(t0);
+        t0 = chrono::steady_clock::now();
+        sparse.runValueIteration(1e-6);
+        double csrSolve = since(t0);
+
+        double denseBytes = (double)S*A*S*sizeof(double);
+        cout << left << setw(8) << (to_string(D) + " x " + to_string(K)) << right << setw(8) << S << setw(11) << sparse.T.nnz()
+             << setw(7) << sparse.iterations << fixed << setprecision(1) << setw(11) << denseBytes/1e6 << setw(9)
+             << sparse.T.bytes()/1e6;
+        if (denseBytes > 1e9) {
+            cout << setw(13) << "skipped" << setw(11) << csrBuild << setw(13) << "skipped" << setw(11) << csrSolve << "\n";
+            continue;
+        }
+        t0 = chrono::steady_clock::now();
+        DynamicTrafficMDP dense(S, A);
+        dense.cost = costs;
+        vector<double> totals((size_t)S*A, 0.0);
+        for (uint64_t k : keys) { dense.prob[k] += 1.0; totals[k / S] += 1.0; }
+        for (size_t r=0; r<totals.size(); r++) {
+            if (totals[r] > 0) for (int e=0; e<S; e++) dense.prob[r*S + e] /= totals[r];
+        }
+        double denseBuild = since(t0);
+        t0 = chrono::steady_clock::now();
+        dense.runValueIteration(1e-6);
+        double denseSolve = since(t0);
+        bool same = dense.Vprev == sparse.Vprev;
+        cout << setw(13) << denseBuild << setw(11) << csrBuild << setw(13) << denseSolve << setw(11) << csrSolve
+             << setw(8) << denseSolve/csrSolve << "x  " << (same ? "match" : "DIFFER") << "\n";
+    }
+}
+
+// Every solver mode on the loaded model (re-solved `reps` times) and on a
+// synthetic 3-direction, 3-level sparse model, against Jacobi's values and
+// policy.
+static void benchSolvers(const TrafficMDP& mdp, int reps) {
+    vector<SolverOptions> modes = {
+        {SolverMode::Jacobi}, {SolverMode::GaussSeidel}, {SolverMode::SOR, 1.1}, {SolverMode::SOR, 1.3},
+        {SolverMode::SOR, 1.5}, {SolverMode::Prioritized}
+    };
+    auto run = [&](const string& title, auto model, int times) {
+        cout << "[BENCH] " << title << ", " << model.numStates() << " states, tol 1e-6\n";
+        cout << left << setw(18) << "solver" << right << setw(7) << "iters" << setw(10) << "updates" << setw(13)
+             << "us/solve" << setw(13) << "max |dV|" << "  policy\n";
+        vector<double> refV;
+        vector<int> refPolicy;
+        for (const auto& opts : modes) {
+            auto t0 = chrono::steady_clock::now();
+            for (int r=0;r<times;r++) model.runValueIteration(1e-6, opts);
+            double us = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count() / times;
+            vector<double> v(model.Vprev.begin(), model.Vprev.end());
+            vector<int> policy;
+            for (int st=0; st<model.numStates(); st++) policy.push_back(st==model.goal ? -1 : bestActionOf(model, st));
+            if (refV.empty()) { refV = v; refPolicy = policy; }
+            double maxDiff = 0;
+            for (size_t st=0; st<v.size(); st++) maxDiff = max(maxDiff, fabs(v[st]-refV[st]));
+            string name = solverName(opts.mode);
+            if (opts.mode == SolverMode::SOR) { ostringstream w; w << " w=" << opts.omega; name += w.str(); }
+            cout << left << setw(18) << name << right << setw(7) << model.iterations << setw(10) << model.updates
+                 << fixed << setprecision(2) << setw(13) << us << scientific << setprecision(1) << setw(13) << maxDiff
+                 << defaultfloat << "  " << (policy == refPolicy ? "same" : "DIFFERS") << "\n";
+        }
+    };
+    run("loaded model", BasicTrafficMDP<8,3>(mdp), reps);
+    mt19937_64 rng(42);
+    vector<uint64_t> keys = syntheticKeys(3, 3, 50000, rng);
+    vector<double> costs;
+    for (int a=0; a<3; a++) costs.push_back(20.0 + 5.0*a);
+    run("synthetic 3x3 CSR", SparseTrafficMDP(CsrTransitions::fromKeys(27, 3, keys), costs), reps/10 + 1);
+}
+
 // ---------------------------- Analysis & Reporting ----------------------------
 class TrafficAnalysis {
 public:
@@ -348,24 +1164,102 @@ int main(int argc, char** argv){
     // ---- Config (mirrors Python defaults) ----
     EnvConfig cfg; // defaults already set to match the Python header
 
-    string csvPath = (argc>1? string(argv[1]) : string("Performance Measurement System (PeMS).csv"));
+    string csvPath = "Performance Measurement System (PeMS).csv";
+    int benchSolveReps = 0;
+    bool benchSparseMode = false, general = false;
+    size_t benchRows = 2000000;
+    string schemaPath;
+    size_t benchCsvMB = 0;
+    unsigned buildThreads = 0;
+    int benchSolversReps = 0;
+    SolverOptions solver;
+    bool solverGiven = false;
+    for (int i=1;i<argc;i++) {
+        string arg = argv[i];
+        if (arg=="--bench-solve") benchSolveReps = (i+1<argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 20000;
+        else if (arg=="--bench-sparse") {
+            benchSparseMode = true;
+            if (i+1<argc && isdigit((unsigned char)argv[i+1][0])) benchRows = stoull(argv[++i]);
+        }
+        else if (arg=="--bench-csv") {
+            benchCsvMB = 64;
+            if (i+1<argc && isdigit((unsigned char)argv[i+1][0])) benchCsvMB = stoull(argv[++i]);
+        }
+        else if (arg=="--threads" && i+1<argc) buildThreads = (unsigned)atoi(argv[++i]);
+        else if (arg=="--bench-solvers") benchSolversReps = (i+1<argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 2000;
+        else if (arg=="--solver" && i+1<argc) {
+            solverGiven = true;
+            if (!parseSolverMode(argv[++i], solver.mode)) {
+                cerr << "[ERROR] Unknown solver '" << argv[i] << "' (jacobi, gauss-seidel, sor, prioritized)\n";
+                return 1;
+            }
+        }
+        else if (arg=="--omega" && i+1<argc) {
+            solver.omega = atof(argv[++i]);
+            if (!(solver.omega > 0 && solver.omega < 2)) { cerr << "[ERROR] --omega must be in (0, 2)\n"; return 1; }
+        }
+        else if (arg=="--general") general = true;
+        else if (arg=="--schema" && i+1<argc) { schemaPath = argv[++i]; general = true; }
+        else csvPath = arg;
+    }
+    if (benchSparseMode) {
+        benchSparse({{3,2},{4,3},{4,5},{5,5},{6,5}}, benchRows);
+        return 0;
+    }
 
-    // ---- Load data ----
-    auto mdata = loadCSV(csvPath, ';');
-    if (mdata.empty()) {
-        cerr << "[WARN] No data loaded. The model will still run but transitions will be zero.\n";
+    if (benchCsvMB > 0) {
+        benchCSV(csvPath, benchCsvMB);
+        return 0;
+    }
+
+    // ---- Generalized model: schema from --schema, else the CSV header, else N/E/W x Low/High ----
+    if (general) {
+        auto mdata = loadCSVMapped(csvPath, ';');
+        if (mdata.empty()) {
+            cerr << "[WARN] No data loaded. The model will still run but transitions will be zero.\n";
+        }
+        StateSchema sc; string err;
+        bool ok = true;
+        if (!schemaPath.empty()) {
+            auto lines = loadCSVMapped(schemaPath, ';');
+            if (lines.empty()) { cerr << "[ERROR] Empty or missing schema: " << schemaPath << "\n"; return 1; }
+            for (auto& cells : lines) ok = ok && sc.parse(cells, err);
+        } else if (!mdata.empty() && !mdata[0].empty() && !mdata[0][0].empty() && mdata[0][0][0]=='#') {
+            ok = sc.parse(mdata[0], err);
+        }
+        if (!ok) { cerr << "[ERROR] Schema: " << err << "\n"; return 1; }
+        return runGeneral(mdata, sc, CostModel::make(cfg), solver);
     }
 
     // ---- Build MDP ----
     TrafficMDP mdp;
-    mdp.buildProbabilities(mdata);
+    {
+        // ---- Load data: counted while it is read ----
+        MappedCSV csv(csvPath);
+        if (mdp.buildProbabilities(csv, buildThreads) == 0) {
+            cerr << "[WARN] No data loaded. The model will still run but transitions will be zero.\n";
+        }
+    }
 
     // Costs
     CostModel cm = CostModel::make(cfg);
     mdp.setCosts(cm.cost);
 
+    if (benchSolveReps > 0) {
+        benchSolve(mdp, benchSolveReps);
+        return 0;
+    }
+    if (benchSolversReps > 0) {
+        benchSolvers(mdp, benchSolversReps);
+        return 0;
+    }
+
     // Value Iteration
-    mdp.runValueIteration(1e-6);
+    mdp.runValueIteration(1e-6, solver);
+    if (solverGiven) {
+        cerr << "[SOLVER] " << solverName(solver.mode) << ": " << mdp.iterations << " iterations, " << mdp.updates
+             << " state updates, " << fixed << setprecision(1) << mdp.solveSeconds*1e6 << " us\n";
+    }
 
     // ---- Output similar to Python ----
     TrafficAnalysis::printExpectedValues(mdp);
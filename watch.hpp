@@ -0,0 +1,594 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "cache.hpp"
+#include "driver.hpp"
+
+// hydro --watch: rebuilds `out` every time the input file is saved.
+//
+// At -O0 the program is held as a list of segments, one per top-level
+// statement together with the whitespace and comments after it. A save is
+// diffed against the previous text, and only the segments the edit touches
+// are lexed and parsed again, into the same parser arena. Their assembly is
+// generated again, along with any later fragment whose variables moved on
+// the stack (or, with -g, whose line numbers moved). Fragments are packed
+// into content-addressed objects in out.watch/, so a rebuild assembles the
+// object holding the edit and relinks. Anything the incremental path cannot
+// handle, such as a block comment left open or a syntax error, falls back to
+// rebuilding everything. -O1 and -O2 optimize across statements, so there
+// every save is an ordinary compile.
+class WatchSession {
+public:
+    explicit WatchSession(DriverOptions opts)
+        : m_opts(std::move(opts))
+    {
+    }
+
+    // Only returns if the input cannot be watched.
+    int run()
+    {
+        if (m_opts.profile_generate.has_value() || m_opts.profile_use.has_value() || m_opts.emit_hyc.has_value()
+            || m_opts.input_path.ends_with(".hyc")) {
+            std::cerr << "[Watch] Profiles and .hyc files are not supported with --watch" << std::endl;
+            return EXIT_FAILURE;
+        }
+        const std::filesystem::path path = std::filesystem::absolute(m_opts.input_path);
+        // The directory is watched rather than the file, since editors often
+        // save by renaming a new file over the old one.
+        const int fd = inotify_init1(IN_CLOEXEC);
+        if (fd < 0 || inotify_add_watch(fd, path.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            std::cerr << "[Watch] " << path.parent_path().string() << ": " << std::strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (m_opts.opt_level > 0) {
+            std::cerr << "[Watch] -O" << m_opts.opt_level
+                      << " optimizes across statements, so every change is a full compile" << std::endl;
+        }
+        rebuild(path);
+        alignas(inotify_event) char events[4096];
+        while (true) {
+            const ssize_t n = read(fd, events, sizeof(events));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "[Watch] " << std::strerror(errno) << std::endl;
+                close(fd);
+                return EXIT_FAILURE;
+            }
+            bool changed = false;
+            for (ssize_t i = 0; i < n;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(events + i);
+                changed |= event->len > 0 && path.filename() == event->name;
+                i += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+            if (changed) {
+                rebuild(path);
+            }
+        }
+    }
+
+private:
+    struct Segment {
+        size_t begin = 0; // in m_source; the segment runs up to the next one
+        int line = 1; // of `begin`
+        NodeStmt* stmt = nullptr;
+        uint64_t id = 0; // makes the fragment's labels unique
+        int line_shift = 0; // lines the statement moved since it was parsed
+        std::optional<Generator::TopLevelMark> entry {}; // what `fragment` was generated against
+        std::string fragment {};
+        std::string hash {}; // of `fragment`
+    };
+
+    // What one rebuild did, for the report line.
+    struct Work {
+        bool full = false;
+        size_t reparsed = 0;
+        size_t regenerated = 0;
+        size_t assembled = 0;
+        size_t objects = 0;
+    };
+
+    void rebuild(const std::filesystem::path& path)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::ifstream input(path);
+        if (!input.is_open()) {
+            return;
+        }
+        std::stringstream contents;
+        contents << input.rdbuf();
+        bool ok = false;
+        Work work;
+        if (m_opts.opt_level > 0) {
+            ok = m_driver.compile(m_opts) == EXIT_SUCCESS;
+            work.full = true;
+        }
+        else {
+            try {
+                update(contents.str(), work);
+                ok = link(work);
+            }
+            catch (const CompileError&) {
+            }
+            if (!ok) {
+                // Whatever was half updated is rebuilt from scratch next time.
+                m_segments.clear();
+                m_source.clear();
+            }
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (!ok) {
+            std::cerr << "[Watch] Build failed; waiting for changes" << std::endl;
+            return;
+        }
+        std::cerr << "[Watch] Rebuilt in " << std::fixed << std::setprecision(1) << ms << " ms";
+        if (m_opts.opt_level == 0) {
+            std::cerr << " (" << (work.full ? "full, " : "") << work.reparsed << " of " << m_segments.size()
+                      << " statements parsed, " << work.regenerated << " generated, " << work.assembled << " of "
+                      << work.objects << " objects assembled)";
+        }
+        std::cerr << std::endl;
+    }
+
+    // Brings the segments and their fragments up to date with `source`.
+    void update(std::string source, Work& work)
+    {
+        // Rebuilt from scratch once edits have filled the arena with dead
+        // nodes, so it does not grow without bound.
+        const bool arena_full = m_parser.has_value()
+            && m_parser->allocator().used() > 4 * std::max<size_t>(m_full_arena_bytes, 1024 * 1024);
+        if (!m_segments.empty() && !arena_full) {
+            std::optional<size_t> first;
+            {
+                // Failures here are retried as a full rebuild, which reports them.
+                const CerrSilencer silence;
+                try {
+                    first = update_incremental(source, work);
+                }
+                catch (const CompileError&) {
+                }
+            }
+            if (first.has_value()) {
+                m_source = std::move(source);
+                generate(first.value(), work);
+                return;
+            }
+        }
+        work = { .full = true };
+        update_full(source, work);
+        m_source = std::move(source);
+        generate(0, work);
+    }
+
+    void update_full(const std::string& source, Work& work)
+    {
+        m_segments.clear();
+        std::vector<Token> tokens;
+        std::vector<size_t> offsets;
+        if (!ChunkLexer(source, 1, false).lex(tokens, &offsets)) {
+            std::cerr << "Invalid token" << std::endl;
+            compile_error();
+        }
+        const std::optional<std::vector<std::pair<size_t, size_t>>> stmts = split_stmts(tokens);
+        if (m_parser.has_value()) {
+            m_parser->reset(tokens);
+        }
+        else {
+            m_parser.emplace(tokens);
+        }
+        const std::optional<NodeProg> prog = m_parser->parse_prog();
+        if (!stmts.has_value() || stmts->size() != prog->stmts.size()) {
+            std::cerr << "Invalid program" << std::endl;
+            compile_error();
+        }
+        m_full_arena_bytes = m_parser->allocator().used();
+        for (size_t k = 0; k < stmts->size(); k++) {
+            const size_t first_token = (*stmts)[k].first;
+            m_segments.push_back({ .begin = k == 0 ? 0 : offsets[first_token],
+                                   .line = k == 0 ? 1 : tokens[first_token].line,
+                                   .stmt = prog->stmts[k],
+                                   .id = m_next_id++ });
+        }
+        work.reparsed = m_segments.size();
+
+        GenOptions gen_options;
+        if (m_opts.debug_info) {
+            gen_options.debug_source = std::filesystem::absolute(m_opts.input_path).string();
+        }
+        m_gen.emplace(NodeProg {}, gen_options);
+        m_prologue = m_gen->fragment_prologue();
+    }
+
+    // Re-parses the segments an edit touched. Returns the index of the first
+    // new segment, or nothing if the edit needs a full rebuild.
+    std::optional<size_t> update_incremental(const std::string_view source, Work& work)
+    {
+        const std::string_view old = m_source;
+        size_t prefix = 0;
+        while (prefix < old.size() && prefix < source.size() && old[prefix] == source[prefix]) {
+            prefix++;
+        }
+        if (prefix == old.size() && prefix == source.size()) {
+            return m_segments.size();
+        }
+        size_t suffix = 0;
+        while (suffix < old.size() - prefix && suffix < source.size() - prefix
+               && old[old.size() - 1 - suffix] == source[source.size() - 1 - suffix]) {
+            suffix++;
+        }
+        const auto containing = [&](const size_t byte) {
+            const auto it = std::ranges::upper_bound(m_segments, byte, {}, &Segment::begin);
+            return static_cast<size_t>(it - m_segments.begin()) - 1;
+        };
+        const size_t i = containing(prefix);
+        size_t j = old.size() - suffix > prefix ? containing(old.size() - suffix - 1) : i;
+        const std::ptrdiff_t delta = static_cast<std::ptrdiff_t>(source.size()) - static_cast<std::ptrdiff_t>(old.size());
+        const size_t begin = m_segments[i].begin;
+        const auto region = [&] { return source.substr(begin, segment_end(j) + delta - begin); };
+        // The edited text must end where a token of the next segment can start.
+        while (j + 1 < m_segments.size()) {
+            const std::string_view text = region();
+            const size_t last_line = text.rfind('\n');
+            const bool joins = !text.empty() && std::isalnum(text.back()) && std::isalnum(old[segment_end(j)]);
+            if (!joins && text.find("//", last_line == std::string_view::npos ? 0 : last_line) == std::string_view::npos) {
+                break;
+            }
+            j++;
+        }
+        const std::string_view text = region();
+        if (ChunkLexer::ends_in_block_comment(text, false)) {
+            return {};
+        }
+        std::vector<Token> tokens;
+        std::vector<size_t> offsets;
+        if (!ChunkLexer(text, m_segments[i].line, false).lex(tokens, &offsets)) {
+            return {};
+        }
+        const std::optional<std::vector<std::pair<size_t, size_t>>> stmts = split_stmts(tokens);
+        if (!stmts.has_value()) {
+            return {};
+        }
+        std::vector<Segment> fresh;
+        for (const auto& [first, last] : stmts.value()) {
+            m_parser->append({ tokens.begin() + static_cast<std::ptrdiff_t>(first),
+                               tokens.begin() + static_cast<std::ptrdiff_t>(last) });
+            const std::optional<NodeProg> prog = m_parser->parse_prog();
+            if (prog->stmts.size() != 1) {
+                return {};
+            }
+            fresh.push_back({ .begin = fresh.empty() ? begin : begin + offsets[first],
+                              .line = fresh.empty() ? m_segments[i].line : tokens[first].line,
+                              .stmt = prog->stmts.front(),
+                              .id = m_next_id++ });
+        }
+        work.reparsed = fresh.size();
+
+        // Nothing before segment i changed, so neither did its entry state.
+        const Generator::TopLevelMark entry = m_segments[i].entry.value();
+        const int line_delta = static_cast<int>(std::ranges::count(text, '\n'))
+            - static_cast<int>(std::ranges::count(old.substr(begin, segment_end(j) - begin), '\n'));
+        for (size_t k = j + 1; k < m_segments.size(); k++) {
+            m_segments[k].begin += delta;
+            m_segments[k].line += line_delta;
+            m_segments[k].line_shift += line_delta;
+        }
+        m_segments.erase(m_segments.begin() + static_cast<std::ptrdiff_t>(i),
+                         m_segments.begin() + static_cast<std::ptrdiff_t>(j + 1));
+        m_segments.insert(m_segments.begin() + static_cast<std::ptrdiff_t>(i), fresh.begin(), fresh.end());
+        if (!m_segments.empty()) {
+            // The first segment also holds whatever precedes the first statement.
+            m_segments.front().begin = 0;
+            m_segments.front().line = 1;
+        }
+        m_gen->rewind_top_level(entry);
+        return i;
+    }
+
+    // Generates fragments from segment `first` on that are new or no longer
+    // fit where they are, and replays the declarations of the rest.
+    void generate(const size_t first, Work& work)
+    {
+        if (first == 0) {
+            m_gen->rewind_top_level({});
+        }
+        for (size_t k = first; k < m_segments.size(); k++) {
+            Segment& seg = m_segments[k];
+            const Generator::TopLevelMark entry = m_gen->top_level_mark();
+            if (seg.entry == entry && (seg.line_shift == 0 || !m_opts.debug_info)) {
+                m_gen->skip_top_level(seg.stmt);
+                continue;
+            }
+            if (seg.line_shift != 0) {
+                shift_lines(seg.stmt, seg.line_shift);
+                seg.line_shift = 0;
+            }
+            seg.fragment = m_gen->gen_fragment(seg.stmt, std::to_string(seg.id) + "_");
+            CacheKey hasher;
+            hasher.update(seg.fragment);
+            seg.hash = hasher.hex();
+            seg.entry = entry;
+            work.regenerated++;
+        }
+        const bool ends_in_exit
+            = !m_segments.empty() && std::holds_alternative<NodeStmtExit*>(m_segments.back().stmt->var);
+        m_epilogue = m_gen->fragment_epilogue(ends_in_exit);
+    }
+
+    // Packs the fragments into objects, assembles the ones that are not on
+    // disk yet and links. Object boundaries depend on the fragments around
+    // them only, so an edit leaves the other objects' names unchanged.
+    bool link(Work& work)
+    {
+        const std::filesystem::path dir = "out.watch";
+        std::filesystem::create_directories(dir);
+        const std::string header = "section .text align=1\nextern hydro_print\nextern hydro_exit\n";
+        std::vector<std::pair<std::string, std::string>> objects; // name, assembly
+        size_t begin = 0;
+        while (begin <= m_segments.size()) {
+            constexpr size_t min_bytes = 64 * 1024;
+            constexpr size_t max_bytes = 256 * 1024;
+            CacheKey hasher;
+            hasher.update(begin == 0 ? m_prologue : "");
+            size_t bytes = 0;
+            size_t end = begin;
+            while (end < m_segments.size() && bytes < max_bytes) {
+                const Segment& seg = m_segments[end++];
+                hasher.update(seg.hash);
+                bytes += seg.fragment.size();
+                if (bytes >= min_bytes && seg.hash.back() == '0') {
+                    break;
+                }
+            }
+            const bool last = end == m_segments.size();
+            if (last) {
+                hasher.update(m_epilogue);
+            }
+            hasher.update(m_opts.debug_info ? "-g" : "");
+            std::string text = header;
+            if (begin == 0) {
+                text += m_prologue;
+            }
+            for (size_t k = begin; k < end; k++) {
+                text += m_segments[k].fragment;
+            }
+            if (last) {
+                text += "global hydro_print\nglobal hydro_exit\n" + m_epilogue;
+            }
+            objects.emplace_back(hasher.hex(), std::move(text));
+            if (last) {
+                break;
+            }
+            begin = end;
+        }
+
+        std::string link_cmd = "ld -o out";
+        std::unordered_set<std::string> live;
+        for (const auto& [name, text] : objects) {
+            const std::filesystem::path object = dir / (name + ".o");
+            link_cmd += " " + object.string();
+            live.insert(name + ".o");
+            live.insert(name + ".asm");
+            if (std::filesystem::exists(object)) {
+                continue;
+            }
+            const std::filesystem::path source = dir / (name + ".asm");
+            std::ofstream(source) << text;
+            const std::string assemble_cmd = std::string(m_opts.debug_info ? "nasm -felf64 -g -F dwarf" : "nasm -felf64")
+                + " -o " + object.string() + " " + source.string();
+            if (system(assemble_cmd.c_str()) != 0) {
+                std::filesystem::remove(object);
+                std::cerr << "Assembling failed" << std::endl;
+                return false;
+            }
+            work.assembled++;
+        }
+        work.objects = objects.size();
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (!live.contains(entry.path().filename().string())) {
+                std::filesystem::remove(entry.path());
+            }
+        }
+        if (system(link_cmd.c_str()) != 0) {
+            std::cerr << "Linking failed" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] size_t segment_end(const size_t k) const
+    {
+        return k + 1 < m_segments.size() ? m_segments[k + 1].begin : m_source.size();
+    }
+
+    // Token ranges of the top-level statements, or nothing if the tokens do
+    // not end on a statement boundary. A statement ends at a `;` outside any
+    // brackets, or at the `}` closing its outermost block unless an `elif`
+    // or `else` follows.
+    static std::optional<std::vector<std::pair<size_t, size_t>>> split_stmts(const std::vector<Token>& tokens)
+    {
+        std::vector<std::pair<size_t, size_t>> stmts;
+        size_t begin = 0;
+        int depth = 0;
+        for (size_t k = 0; k < tokens.size(); k++) {
+            switch (tokens[k].type) {
+            case TokenType::open_paren:
+            case TokenType::open_curly:
+            case TokenType::open_bracket:
+                depth++;
+                break;
+            case TokenType::close_paren:
+            case TokenType::close_bracket:
+                depth--;
+                break;
+            case TokenType::close_curly:
+                if (--depth == 0
+                    && (k + 1 == tokens.size()
+                        || (tokens[k + 1].type != TokenType::elif && tokens[k + 1].type != TokenType::else_))) {
+                    stmts.emplace_back(begin, k + 1);
+                    begin = k + 1;
+                }
+                break;
+            case TokenType::semi:
+                if (depth == 0) {
+                    stmts.emplace_back(begin, k + 1);
+                    begin = k + 1;
+                }
+                break;
+            default:
+                break;
+            }
+            if (depth < 0) {
+                return {};
+            }
+        }
+        if (begin != tokens.size()) {
+            return {};
+        }
+        return stmts;
+    }
+
+    // Moves the line numbers -g puts in the line table.
+    static void shift_lines(NodeStmt* stmt, const int delta) // NOLINT(*-no-recursion)
+    {
+        struct Shifter {
+            int delta;
+
+            void expr(NodeExpr* expr) const // NOLINT(*-no-recursion)
+            {
+                expr->line += delta;
+                if (const auto bin = std::get_if<NodeBinExpr*>(&expr->var)) {
+                    std::visit(
+                        [&](auto* op) {
+                            this->expr(op->lhs);
+                            this->expr(op->rhs);
+                        },
+                        (*bin)->var);
+                }
+                else if (const auto paren = std::get_if<NodeTermParen*>(&std::get<NodeTerm*>(expr->var)->var)) {
+                    this->expr((*paren)->expr);
+                }
+                else if (const auto index = std::get_if<NodeTermIndex*>(&std::get<NodeTerm*>(expr->var)->var)) {
+                    this->expr((*index)->index);
+                }
+            }
+
+            void scope(const NodeScope* scope) const
+            {
+                for (NodeStmt* stmt : scope->stmts) {
+                    shift_lines(stmt, delta);
+                }
+            }
+
+            void operator()(const NodeStmtExit* stmt) const
+            {
+                expr(stmt->expr);
+            }
+
+            void operator()(const NodeStmtPrint* stmt) const
+            {
+                expr(stmt->expr);
+            }
+
+            void operator()(const NodeStmtLet* stmt) const
+            {
+                expr(stmt->expr);
+            }
+
+            void operator()(const NodeStmtAssign* stmt) const
+            {
+                expr(stmt->expr);
+            }
+
+            void operator()(const NodeStmtAssignIndex* stmt) const
+            {
+                expr(stmt->index);
+                expr(stmt->expr);
+            }
+
+            void operator()(const NodeStmtLetArray*) const
+            {
+            }
+
+            void operator()(const NodeScope* stmt) const
+            {
+                scope(stmt);
+            }
+
+            void operator()(const NodeStmtIf* stmt) const
+            {
+                expr(stmt->expr);
+                scope(stmt->scope);
+                std::optional<NodeIfPred*> pred = stmt->pred;
+                while (pred.has_value()) {
+                    if (const auto elif = std::get_if<NodeIfPredElif*>(&pred.value()->var)) {
+                        expr((*elif)->expr);
+                        scope((*elif)->scope);
+                        pred = (*elif)->pred;
+                    }
+                    else {
+                        scope(std::get<NodeIfPredElse*>(pred.value()->var)->scope);
+                        pred.reset();
+                    }
+                }
+            }
+        };
+
+        stmt->line += delta;
+        std::visit(Shifter { .delta = delta }, stmt->var);
+    }
+
+    // Discards std::cerr output for its lifetime.
+    class CerrSilencer {
+    public:
+        CerrSilencer()
+            : m_saved(std::cerr.rdbuf(&m_null))
+        {
+        }
+
+        CerrSilencer(const CerrSilencer&) = delete;
+        CerrSilencer& operator=(const CerrSilencer&) = delete;
+
+        ~CerrSilencer()
+        {
+            std::cerr.rdbuf(m_saved);
+        }
+
+    private:
+        struct NullBuf : std::streambuf {
+            int overflow(const int c) override
+            {
+                return c;
+            }
+        };
+
+        NullBuf m_null;
+        std::streambuf* m_saved;
+    };
+
+    DriverOptions m_opts;
+    Driver m_driver {};
+    std::string m_source {};
+    std::vector<Segment> m_segments {}; // empty until a build succeeds
+    std::optional<Parser> m_parser {};
+    size_t m_full_arena_bytes = 0;
+    std::optional<Generator> m_gen {};
+    std::string m_prologue {};
+    std::string m_epilogue {};
+    uint64_t m_next_id = 0;
+};